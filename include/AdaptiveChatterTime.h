@@ -0,0 +1,79 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef KEYCHATTERING_ADAPTIVECHATTERTIME_H_
+#define KEYCHATTERING_ADAPTIVECHATTERTIME_H_
+
+#include "ChatterClock.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* Per key chatter time learned from the keyboard.
+* For each key, the time between two presses separated by a release
+* is counted into a histogram of bucketCount buckets between zero and
+* the maximum chatter time. The chatter of a key forms the first group
+* of consecutive non empty buckets, the chatter time of the key is the
+* end of this group plus one bucket, kept between the minimum and the
+* maximum. The presses of the user, slower than the maximum, are not
+* counted into the buckets, so a key that never chatters gets the minimum.
+* The counts are halved every decayPeriod presses of the key, so an
+* old chatter is forgotten. Recording a time is O(1), the chatter
+* time is computed again every updatePeriod presses.
+* The memory is fixed at construction.
+*/
+class AdaptiveChatterTime
+{
+    AdaptiveChatterTime(const AdaptiveChatterTime&) = delete;
+    AdaptiveChatterTime& operator=(const AdaptiveChatterTime&) = delete;
+
+public:
+    static const std::size_t bucketCount = 32;
+    static const std::uint16_t minimumSampleCount = 16;
+    static const std::uint16_t updatePeriod = 8;
+    static const std::uint16_t decayPeriod = 256;
+
+    explicit AdaptiveChatterTime(std::size_t keyCount);
+
+    void setBounds(ChatterTime minimum, ChatterTime maximum);
+    ChatterTime minimum() const;
+    ChatterTime maximum() const;
+    void reset();
+    void reset(std::size_t key);
+
+    // Count the time between two presses of the key. Return true and
+    // set chatterTime when the chatter time of the key is computed again.
+    bool record(std::size_t key, ChatterTime interval, ChatterTime& chatterTime);
+
+private:
+    struct KeyHistogram
+    {
+        std::uint16_t counts[bucketCount];
+        std::uint16_t sampleCount;
+    };
+
+    ChatterTime computeChatterTime(const KeyHistogram& histogram) const;
+
+    std::vector<KeyHistogram> m_keys;
+    ChatterTime m_minimum;
+    ChatterTime m_maximum;
+    ChatterTime m_bucketWidth;
+};
+
+#endif // KEYCHATTERING_ADAPTIVECHATTERTIME_H_
@@ -21,12 +21,26 @@
 
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include <windows.h>
 
-class Application
+#include "HookWatchdog.h"
+
+/*
+* Lifecycle of the program. The main thread sleeps on a condition
+* variable until the hook thread is initialized, then until the program
+* is asked to quit (Ctrl+C, closing the console, end of the hook thread).
+* The main thread then frees the resources. The only thread waking up
+* periodically is the hook watchdog, and only while key events are
+* processed or a doubt about the hook is checked, never while idle: when
+* the hook is dropped by the system, the watchdog installs it again on
+* a new hook thread, the thread of the previous hook then exits.
+*/
+class Application : public WatchedHook
 {
     Application(const Application&) = delete;
     Application(int &argc, char**& argv);
@@ -38,18 +52,30 @@ public:
     static Application* instance();
     bool run();
 
+    bool reinstall() override;
+    void probe() override;
+
 private:
     void init(int& argc, char**& argv);
     void deinit();
-    void initAndRunKeyboardHook();
+    bool installKeyboardHook();
+    void runKeyboardHook();
     void createCtrlCSignalHandler();
+    void quit();
+    void quitAndWait();
     static BOOL WINAPI ctrlcSignalHandler(DWORD signal);
 
     std::atomic<bool> m_isApplicationRunning;
     std::atomic<int> m_initSuccess;
-    std::thread m_tKeyboardHook;
+    std::vector<std::thread> m_tKeyboardHooks;
     std::atomic<HHOOK> m_hookID;
     std::atomic<DWORD> m_hookThreadID;
+    HHOOK m_installedHookID;
+    DWORD m_installedThreadID;
+    unsigned int m_installCount;
+    std::mutex m_stateMutex;
+    std::condition_variable m_stateCondition;
+    bool m_isFinished;
 
     static std::unique_ptr<Application> _instance;
 };
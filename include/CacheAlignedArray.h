@@ -0,0 +1,65 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_CACHEALIGNEDARRAY_H_
+#define KEYCHATTERING_CACHEALIGNEDARRAY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/*
+* Fixed size array whose first element starts on a cache line.
+* The storage is embedded into the object and the alignment is done
+* at runtime, so it also works when the owner is allocated with a plain
+* new, which does not honour extended alignment before C++17.
+*/
+template<typename T, std::size_t N, std::size_t Alignment = 64>
+class CacheAlignedArray
+{
+    CacheAlignedArray(const CacheAlignedArray&) = delete;
+    CacheAlignedArray& operator=(const CacheAlignedArray&) = delete;
+
+public:
+    CacheAlignedArray()
+    {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_storage);
+        address = (address + Alignment - 1) & ~std::uintptr_t(Alignment - 1);
+        m_data = reinterpret_cast<T*>(address);
+        for (std::size_t i = 0; i < N; i++)
+            new (m_data + i) T();
+    }
+
+    ~CacheAlignedArray()
+    {
+        for (std::size_t i = 0; i < N; i++)
+            m_data[i].~T();
+    }
+
+    T& operator[](std::size_t i) { return m_data[i]; }
+    const T& operator[](std::size_t i) const { return m_data[i]; }
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+    static std::size_t size() { return N; }
+
+private:
+    unsigned char m_storage[sizeof(T) * N + Alignment - 1];
+    T* m_data;
+};
+
+#endif // KEYCHATTERING_CACHEALIGNEDARRAY_H_
@@ -0,0 +1,80 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_CHATTERCLOCK_H_
+#define KEYCHATTERING_CHATTERCLOCK_H_
+
+#include <chrono>
+#include <cstdint>
+
+// Time of an event, in integer microsecond ticks since the start of the clock.
+typedef std::chrono::duration<std::int64_t, std::micro> ChatterTime;
+
+// Convert a time in milliseconds, rounded to the nearest tick.
+ChatterTime chatterTimeFromMilliseconds(double msec);
+
+// Convert a time into milliseconds, for display.
+double chatterTimeToMilliseconds(ChatterTime time);
+
+// Longest chatter time accepted from the command line, the configuration and the control requests.
+const double maxChatterTimeMilliseconds = 10000.;
+
+// If a chatter time given in milliseconds is at least one tick and at most
+// maxChatterTimeMilliseconds. Infinite and NaN times are rejected.
+bool isValidChatterTime(double msec);
+
+/*
+* Source of time of the chatter engine.
+* The engine itself only works on the timestamps it is given,
+* the clock is used by the code feeding it and by the release scheduler.
+*/
+class ChatterClock
+{
+public:
+    virtual ~ChatterClock();
+    virtual ChatterTime now() const = 0;
+};
+
+// Monotonic clock, used when filtering a real keyboard.
+// Unlike the system time, it does not jump when the date is changed.
+class SteadyChatterClock : public ChatterClock
+{
+public:
+    SteadyChatterClock();
+    ChatterTime now() const override;
+
+    // Time of a point of the steady clock already read, such as the start of the hook.
+    ChatterTime toChatterTime(std::chrono::steady_clock::time_point timePoint) const;
+
+private:
+    std::chrono::steady_clock::time_point m_startTime;
+};
+
+// Virtual clock moved by hand, used when replaying recorded events.
+class ManualChatterClock : public ChatterClock
+{
+public:
+    ManualChatterClock();
+    ChatterTime now() const override;
+    void setTime(ChatterTime time);
+
+private:
+    ChatterTime m_time;
+};
+
+#endif // KEYCHATTERING_CHATTERCLOCK_H_
@@ -0,0 +1,85 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef KEYCHATTERING_CHATTERCONFIG_H_
+#define KEYCHATTERING_CHATTERCONFIG_H_
+
+#include "ChatterClock.h"
+#include "KeyTable.h"
+
+#include <bitset>
+#include <istream>
+#include <string>
+
+// Chatter times of a key.
+struct KeyChatterTime
+{
+    ChatterTime press;   // A press closer than this to the previous press is a chatter.
+    ChatterTime release; // A release closer than this to the press is delayed by this time.
+};
+
+/*
+* Chatter times of each key, read from a configuration file:
+*   # Comment.
+*   default press=<ms> release=<ms>
+*   category <name> [press=<ms>] [release=<ms>] [time=<ms>] [on|off]
+*   key <name|code> [press=<ms>] [release=<ms>] [time=<ms>] [on|off]
+* A name with spaces is written between double quotes ("left shift").
+* A key takes its settings from its key line, then from its category
+* line, then from the default line, whatever their order in the file.
+* A key turned off is never filtered.
+* The settings are compiled into one entry for each virtual key code
+* and a bitset of the keys turned off.
+*/
+class ChatterConfig
+{
+public:
+    ChatterConfig();
+
+    // Chatter time of the keys without setting. Before reading the file,
+    // the default line replaces it, after, it replaces the default line.
+    void setDefaultChatterTime(ChatterTime time);
+    ChatterTime defaultChatterTime() const;
+    bool read(std::istream& stream, std::string& error);
+    // Read a configuration file, the error starts by what went wrong.
+    bool readFile(const std::string& path, std::string& error);
+
+    const KeyChatterTime& keyChatterTime(unsigned long key) const;
+    bool isBypassed(unsigned long key) const;
+    const std::bitset<keyTableSize>& bypassedKeys() const;
+
+private:
+    struct Setting
+    {
+        bool hasPress;
+        bool hasRelease;
+        bool hasEnabled;
+        ChatterTime press;
+        ChatterTime release;
+        bool isEnabled;
+    };
+
+    void compile();
+
+    Setting m_defaultSetting;
+    Setting m_categorySettings[keyCategoryCount];
+    Setting m_keySettings[keyTableSize];
+    KeyChatterTime m_keyChatterTimes[keyTableSize];
+    std::bitset<keyTableSize> m_bypassedKeys;
+};
+
+#endif // KEYCHATTERING_CHATTERCONFIG_H_
@@ -0,0 +1,198 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_CHATTERENGINE_H_
+#define KEYCHATTERING_CHATTERENGINE_H_
+
+#include "AdaptiveChatterTime.h"
+#include "CacheAlignedArray.h"
+#include "ChatterClock.h"
+#include "ChatterConfig.h"
+#include "ChatterPolicy.h"
+#include "ChatterStatistics.h"
+#include "DeviceTable.h"
+#include "RcuPointer.h"
+#include "ReleaseSink.h"
+#include "TimerWheel.h"
+
+#include <bitset>
+#include <memory>
+
+enum class ChatterDecision
+{
+    Pass,   // The event is sent to the system.
+    Block,  // The press is a chatter and is discarded.
+    Delay   // The release is held back until releaseTime.
+};
+
+struct ChatterResult
+{
+    ChatterDecision decision;
+    ChatterTime timeSinceLastPress;
+    ChatterTime releaseTime;
+};
+
+/*
+* Platform independent chatter detection.
+* The engine is given the key events with their timestamp and decides
+* if they are sent to the system. The delayed releases are kept into
+* a timer wheel and sent to a ReleaseSink by releaseDueKeys.
+* Each key has its own press and release chatter times, given by
+* a ChatterConfig or learned by the adaptive chatter time. setChatterTime
+* changes the default time of the configuration, the keys and categories
+* with their own times keep them. The keys turned off by the configuration
+* are never filtered.
+* Each keyboard has its own key data, so two keyboards never share their
+* chatter. The tables of the devices are taken from a pool allocated at
+* construction when their first event is received, the events of the
+* devices beyond the size of the pool share the table of the default device.
+* The decisions can be counted into a ChatterStatistics, see setStatistics.
+* The chatter times and the bypassed keys form one immutable table,
+* replaced as a whole by setChatterTime and setConfig: they may be called
+* from any thread while the events are processed, the events never wait
+* for them and never see a half-written table. A key takes the times of
+* a new table at its next event.
+* Otherwise the engine is not thread safe, see ReleaseScheduler.
+* The press and release rules are given by the Policy (see ChatterPolicy.h),
+* each policy compiles to its own hot path without virtual calls.
+*/
+template<typename Policy>
+class BasicChatterEngine
+{
+    BasicChatterEngine(const BasicChatterEngine&) = delete;
+    BasicChatterEngine& operator=(const BasicChatterEngine&) = delete;
+
+    typedef typename Policy::PressRule PressRule;
+
+    // Press and release data of a key, stored into one cache line.
+    struct alignas(64) KeyInfo
+    {
+        ChatterTime timeWhenPressed;
+        ChatterTime timeWhenLastPressed;
+        ChatterTime timeWhenReleased;
+        KeyChatterTime timeOfChatter;
+        std::uint64_t settingsGeneration; // Generation of the settings timeOfChatter comes from.
+        typename PressRule::KeyState pressState;
+        bool isAlreadyPressed;
+        bool isReleasePending; // The delayed release is in the timer wheel, at slot table * keyCount + key.
+    };
+
+public:
+    // There is only 256 virtual key code, the key info are indexed by them.
+    static const std::size_t keyCount = 256;
+    static const std::size_t defaultDeviceCount = 8;
+
+    explicit BasicChatterEngine(std::size_t deviceCount = defaultDeviceCount);
+
+    // The events of the default device.
+    ChatterResult processKeyEvent(unsigned long key, bool isPressed, ChatterTime time);
+    ChatterResult processKeyPress(unsigned long key, ChatterTime time);
+    ChatterResult processKeyRelease(unsigned long key, ChatterTime time);
+
+    ChatterResult processKeyEvent(DeviceId device, unsigned long key, bool isPressed, ChatterTime time);
+    ChatterResult processKeyPress(DeviceId device, unsigned long key, ChatterTime time);
+    ChatterResult processKeyRelease(DeviceId device, unsigned long key, ChatterTime time);
+
+    // Forget a disconnected device, its delayed releases are cancelled.
+    bool removeDevice(DeviceId device);
+    std::size_t deviceCount() const;
+    std::size_t maxDeviceCount() const;
+
+    std::size_t releaseDueKeys(ChatterTime now, ReleaseSink& sink);
+    bool nextReleaseTime(ChatterTime& time) const;
+    // The slot of a key among the delayed releases (keyCount slots for each
+    // device table) and if its release is delayed. False beyond keyCount.
+    bool isReleasePending(DeviceId device, unsigned long key, std::size_t& slot) const;
+
+    // Thread safe, the next events use the new chatter times.
+    // The chatter time is the default time of the configuration.
+    void setChatterTime(ChatterTime time);
+    ChatterTime chatterTime() const;
+    void setConfig(const ChatterConfig& config);
+
+    // Not thread safe, for the thread giving the events: the settings
+    // have a single reader, and the time learned for a key is its own.
+    KeyChatterTime keyChatterTime(unsigned long key) const;
+    bool isKeyBypassed(unsigned long key) const;
+
+    // Learn the chatter time of each key, between minimum and maximum.
+    // Return false if the policy never learns.
+    bool enableAdaptiveChatterTime(ChatterTime minimum, ChatterTime maximum);
+    void disableAdaptiveChatterTime();
+    bool isAdaptiveChatterTimeEnabled() const;
+
+    // Count the decisions into statistics, nullptr to stop counting.
+    void setStatistics(ChatterStatistics* statistics);
+
+private:
+    // The key info of one device.
+    struct DeviceKeys
+    {
+        CacheAlignedArray<KeyInfo, keyCount> keyInfo;
+    };
+
+    // Chatter times of every key, published by setChatterTime and setConfig.
+    struct ChatterSettings
+    {
+        ChatterTime chatterTime;
+        KeyChatterTime keyTimes[keyCount];
+        std::bitset<keyCount> bypassedKeys;
+    };
+    typedef typename RcuPointer<ChatterSettings>::ReadSection SettingsSection;
+
+    std::size_t tableOfDevice(DeviceId device);
+    bool isLearning() const;
+    ChatterResult pressKey(std::size_t table, unsigned long key, ChatterTime time);
+    ChatterResult releaseKey(std::size_t table, unsigned long key, ChatterTime time);
+    KeyInfo& keyInfoOf(std::size_t table, std::size_t key, const SettingsSection& settings);
+    void cancelRelease(std::size_t table, std::size_t key, KeyInfo& keyInfo);
+    void resetKeyChatterTimes();
+    void compileConfig(ChatterSettings& settings) const;
+    KeyChatterTime configuredChatterTime(std::size_t key, const ChatterSettings& settings) const;
+    void resetKeyInfo(std::size_t table, std::size_t key);
+    void count(std::size_t key, ChatterCounter counter);
+
+    std::unique_ptr<DeviceKeys[]> m_deviceKeys;
+    DeviceTable m_devices;
+    DeviceId m_lastDevice;
+    std::size_t m_lastTable;
+    RcuPointer<ChatterSettings> m_settings;
+    // The configuration the settings are compiled from, the chatter time is
+    // its default. Only changed by the updates of m_settings, one at a time.
+    ChatterConfig m_config;
+    TimerWheel m_pendingReleases;
+    AdaptiveChatterTime m_adaptiveChatterTime;
+    bool m_isAdaptive;
+    ChatterStatistics* m_statistics;
+};
+
+// The policies compiled into the library.
+extern template class BasicChatterEngine<DefaultChatterPolicy>;
+extern template class BasicChatterEngine<FixedWindowPolicy>;
+extern template class BasicChatterEngine<PressOnlyPolicy>;
+extern template class BasicChatterEngine<ReleaseDeferPolicy>;
+extern template class BasicChatterEngine<CountInWindowPolicy<2> >;
+extern template class BasicChatterEngine<AdaptivePolicy>;
+
+// The engine of the program, its policy is chosen when it is built.
+#ifndef KEYCHATTERING_CHATTER_POLICY
+#define KEYCHATTERING_CHATTER_POLICY DefaultChatterPolicy
+#endif
+typedef BasicChatterEngine<KEYCHATTERING_CHATTER_POLICY> ChatterEngine;
+
+#endif // KEYCHATTERING_CHATTERENGINE_H_
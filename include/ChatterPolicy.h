@@ -0,0 +1,138 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_CHATTERPOLICY_H_
+#define KEYCHATTERING_CHATTERPOLICY_H_
+
+#include <cstdint>
+
+/*
+* Filtering policies of the chatter engine, chosen at compile time by
+* the template argument of BasicChatterEngine. A policy gives:
+*   PressRule       What a press after a release, within the press
+*                   chatter time of the accepted press, is.
+*   defersReleases  If a release too close to its press is delayed.
+*   learning        If the chatter time of each key is learned.
+* The rules are inlined into the engine, the code of a feature that
+* a policy does not use is not even compiled into its hot path.
+*/
+
+// How the chatter time of each key is learned, see AdaptiveChatterTime.
+enum class ChatterLearning
+{
+    Never,      // The configured chatter times only.
+    Always,     // Learned from the first press.
+    OnRequest   // Learned once enableAdaptiveChatterTime is called.
+};
+
+// Every press within the window is a chatter, the original rule.
+struct WindowPressRule
+{
+    struct KeyState {};
+
+    static const bool isFiltering = true;
+    static void startWindow(KeyState&) {}
+    static bool isChatter(KeyState&) { return true; }
+};
+
+// The first N presses within the window are chatters, the next one
+// is a new press of the user and starts a new window.
+template<unsigned N>
+struct CountPressRule
+{
+    static_assert(N > 0 && N < 256, "N must be between 1 and 255.");
+
+    struct KeyState
+    {
+        std::uint8_t chatterCount;
+    };
+
+    static const bool isFiltering = true;
+    static void startWindow(KeyState& state) { state.chatterCount = 0; }
+
+    static bool isChatter(KeyState& state)
+    {
+        if (state.chatterCount >= N)
+            return false;
+        state.chatterCount++;
+        return true;
+    }
+};
+
+// No press is a chatter.
+struct PassPressRule
+{
+    struct KeyState {};
+
+    static const bool isFiltering = false;
+    static void startWindow(KeyState&) {}
+    static bool isChatter(KeyState&) { return false; }
+};
+
+// The rules of the program, the chatter times are learned with --adaptive.
+struct DefaultChatterPolicy
+{
+    typedef WindowPressRule PressRule;
+    static const bool defersReleases = true;
+    static const ChatterLearning learning = ChatterLearning::OnRequest;
+};
+
+// The rules of the program with the configured chatter times only.
+struct FixedWindowPolicy
+{
+    typedef WindowPressRule PressRule;
+    static const bool defersReleases = true;
+    static const ChatterLearning learning = ChatterLearning::Never;
+};
+
+// The lowest latency: the releases are never delayed, only the presses are blocked.
+struct PressOnlyPolicy
+{
+    typedef WindowPressRule PressRule;
+    static const bool defersReleases = false;
+    static const ChatterLearning learning = ChatterLearning::Never;
+};
+
+// The presses are never blocked, the chattering releases are delayed.
+struct ReleaseDeferPolicy
+{
+    typedef PassPressRule PressRule;
+    static const bool defersReleases = true;
+    static const ChatterLearning learning = ChatterLearning::Never;
+};
+
+// At most N chatters blocked for each press, so a fast double tap
+// is never lost. The engine is compiled for N = 2, see ChatterEngine.cpp.
+template<unsigned N>
+struct CountInWindowPolicy
+{
+    typedef CountPressRule<N> PressRule;
+    static const bool defersReleases = true;
+    static const ChatterLearning learning = ChatterLearning::Never;
+};
+
+// The chatter time of each key is always learned, between the bounds
+// of enableAdaptiveChatterTime (5 and 50 ms until it is called).
+struct AdaptivePolicy
+{
+    typedef WindowPressRule PressRule;
+    static const bool defersReleases = true;
+    static const ChatterLearning learning = ChatterLearning::Always;
+};
+
+#endif // KEYCHATTERING_CHATTERPOLICY_H_
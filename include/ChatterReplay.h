@@ -0,0 +1,67 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_CHATTERREPLAY_H_
+#define KEYCHATTERING_CHATTERREPLAY_H_
+
+#include "ChatterEngine.h"
+#include "KeyEventTrace.h"
+
+/*
+* Feed recorded key events to a chatter engine under a virtual clock,
+* as fast as possible. Before each event, the delayed releases that are
+* due are sent at their exact time, so the result is the same as if
+* the events were received live. The events can also be given one
+* by one, for a stream whose end is not known.
+*/
+class ChatterReplay : private ReleaseSink
+{
+    ChatterReplay(const ChatterReplay&) = delete;
+    ChatterReplay& operator=(const ChatterReplay&) = delete;
+
+public:
+    explicit ChatterReplay(ChatterEngine& engine);
+    virtual ~ChatterReplay();
+
+    void replay(const KeyEvent* events, std::size_t count);
+    void replay(const std::vector<KeyEvent>& events);
+
+    // Replay one event of a stream, after the releases due before it.
+    void replay(const KeyEvent& event);
+    // Send the delayed releases due before time.
+    void releaseKeysUntil(ChatterTime time);
+
+protected:
+    virtual void onKeyEvent(const KeyEvent& event, const ChatterResult& result) = 0;
+    virtual void onKeyRelease(ChatterTime time, DeviceId device, unsigned long key) = 0;
+
+    // Index of the event given to onKeyEvent: its position in the trace
+    // being replayed, or the number of events of the stream before it.
+    std::size_t eventIndex() const;
+
+private:
+    void releaseKey(unsigned long key) override;
+    void releaseDeviceKeys(DeviceId device, const unsigned long* keys, std::size_t count) override;
+
+    ChatterEngine& m_engine;
+    ManualChatterClock m_clock;
+    std::size_t m_eventIndex;
+    std::size_t m_eventCount;
+};
+
+#endif // KEYCHATTERING_CHATTERREPLAY_H_
@@ -0,0 +1,95 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_CHATTERSTATISTICS_H_
+#define KEYCHATTERING_CHATTERSTATISTICS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// The counters kept for each key.
+enum class ChatterCounter : std::uint32_t
+{
+    PressesSeen,        // Presses given to the engine.
+    PressesBlocked,     // Presses discarded as a chatter.
+    ReleasesDeferred,   // Releases held back by the engine.
+    ReleasesInjected,   // Deferred releases sent back to the system.
+    ReleasesCancelled   // Deferred releases dropped: replaced, or the key was pressed again.
+};
+
+const std::uint32_t chatterStatisticsMagic = 0x5453434B; // "KCST"
+const std::uint32_t chatterStatisticsVersion = 1;
+const std::size_t chatterCounterCount = 5;
+
+// The counters of a key, one cache line. The unused counters are left
+// for the next versions, so the layout of the keys does not change.
+struct ChatterKeyCounters
+{
+    std::atomic<std::uint64_t> counts[8];
+};
+
+/*
+* Live statistics of the chatter engine, with a fixed layout so it can be
+* shared with other processes through a memory mapped file (see StatisticsFile).
+* The counters are updated with relaxed atomic increments, one for most
+* events, and read by the other processes without calling into this one.
+* The totals of all the keys are summed by the readers, so the hook
+* only touches the cache line of its key.
+* The layout only changes with the version. A reader checks the magic,
+* the version and the size before reading the counters.
+*/
+struct ChatterStatistics
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t size;
+    std::uint32_t keyCount;
+    std::uint32_t counterCount;
+    std::uint32_t processId;
+    std::int64_t startTime;                         // Seconds since 1970-01-01 UTC.
+    std::atomic<std::uint64_t> releaseBatches;      // Calls to the sink, several keys released together count once.
+    std::atomic<std::uint64_t> unknownKeyEvents;    // Events whose key is outside the key range.
+    std::uint8_t reserved[16];
+    ChatterKeyCounters keys[256];
+
+    void increment(std::size_t key, ChatterCounter counter)
+    {
+        keys[key].counts[static_cast<std::size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::uint64_t count(std::size_t key, ChatterCounter counter) const
+    {
+        return keys[key].counts[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t total(ChatterCounter counter) const
+    {
+        std::uint64_t sum = 0;
+        for (std::size_t key = 0; key < sizeof(keys) / sizeof(keys[0]); key++)
+            sum += count(key, counter);
+        return sum;
+    }
+};
+
+// The other processes map the counters, they must be plain 64 bits words.
+static_assert(sizeof(std::atomic<std::uint64_t>) == 8, "The counters must be 64 bits words.");
+static_assert(sizeof(ChatterKeyCounters) == 64, "The counters of a key must fill one cache line.");
+static_assert(sizeof(ChatterStatistics) == 64 + 256 * 64, "The layout of ChatterStatistics has changed.");
+
+#endif // KEYCHATTERING_CHATTERSTATISTICS_H_
@@ -20,6 +20,7 @@
 #define KEYCHATTERING_COMMANDLINEPARSING_H_
 
 #include "cxxopts.hpp"
+#include <string>
 
 class CommandLineParsing
 {
@@ -27,14 +28,41 @@ public:
     CommandLineParsing(int& argc, char**& argv);
 
     bool isMSecSet() const;
-    int msec() const;
+    double msec() const;
 
     bool isDebugSet() const;
 
+    bool isAdaptiveSet() const;
+    double adaptiveMinimum() const;
+    double adaptiveMaximum() const;
+
+    bool isConfigSet() const;
+    const std::string& configPath() const;
+
+    bool isStatisticsSet() const;
+    const std::string& statisticsPath() const;
+
+    bool isControlSet() const;
+    const std::string& controlName() const;
+
+    bool isRecordSet() const;
+    const std::string& recordPath() const;
+
 private:
     bool m_msecSet;
-    int m_msec;
+    double m_msec;
     bool m_debugSet;
+    bool m_adaptiveSet;
+    double m_adaptiveMinimum;
+    double m_adaptiveMaximum;
+    bool m_configSet;
+    std::string m_configPath;
+    bool m_statisticsSet;
+    std::string m_statisticsPath;
+    bool m_controlSet;
+    std::string m_controlName;
+    bool m_recordSet;
+    std::string m_recordPath;
 };
 
 #endif // KEYCHATTERING_COMMANDLINEPARSING_H_
\ No newline at end of file
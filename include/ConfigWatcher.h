@@ -0,0 +1,71 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_CONFIGWATCHER_H_
+#define KEYCHATTERING_CONFIGWATCHER_H_
+
+#include "ControlProtocol.h"
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <thread>
+
+/*
+* Reload the configuration file of a running program when it is written.
+* The directory of the file is watched, because the editors often write
+* a new file and rename it over the old one: with inotify, or with a change
+* notification on Windows. The thread of the watcher sleeps until the
+* directory changes, then asks the target to reload the configuration and
+* writes the outcome to the log. A configuration that cannot be read is
+* not used, the previous one is kept.
+*/
+class ConfigWatcher
+{
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+public:
+    ConfigWatcher(ControlTarget& target, std::ostream& log);
+    ~ConfigWatcher();
+
+    bool start(const std::string& path, std::string& error);
+    void stop();
+    bool isRunning() const;
+
+private:
+    void run();
+    void reload();
+
+    ControlTarget& m_target;
+    std::ostream& m_log;
+    std::atomic<bool> m_isRunning;
+    std::thread m_thread;
+    std::string m_fileName;
+#ifdef _WIN32
+    std::string m_path;
+    void* m_change;
+    void* m_stopEvent;
+    unsigned long long m_lastWriteTime;
+#else
+    int m_inotify;
+    int m_wakeUpPipe[2];
+#endif
+};
+
+#endif // KEYCHATTERING_CONFIGWATCHER_H_
@@ -0,0 +1,92 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_CONTROLPROTOCOL_H_
+#define KEYCHATTERING_CONTROLPROTOCOL_H_
+
+#include "ChatterClock.h"
+#include "ChatterStatistics.h"
+#include "HookWatchdog.h"
+#include "LatencyHistogram.h"
+
+#include <string>
+
+/*
+* What the control endpoint can see and change in a running program.
+* The methods are called by the thread of the control server, an
+* implementation must be thread safe but must not slow down the hook.
+*/
+class ControlTarget
+{
+public:
+    virtual ~ControlTarget();
+
+    // nullptr if the program does not keep them.
+    virtual const ChatterStatistics* statistics() const = 0;
+    virtual const HookLatency* hookLatency() const = 0;
+    virtual const HookWatchdog* hookWatchdog() const = 0;
+
+    virtual ChatterTime chatterTime() const = 0;
+    virtual void setChatterTime(ChatterTime time) = 0;
+    // Read the configuration file again and use it if it is valid.
+    virtual bool reloadConfig(std::string& error) = 0;
+    virtual bool isDebugEnabled() const = 0;
+    // Return false if the program has no debug output.
+    virtual bool enableDebug(bool enable) = 0;
+};
+
+/*
+* Text protocol of the control endpoint. A request is one line, the
+* response is made of zero or more lines followed by a line "ok" or
+* "error <message>". The requests are:
+*   ping
+*   stats           "key <code> <presses> <blocked> <deferred> <injected> <cancelled> <name>"
+*                   for each key used, then "total ...", "batches <n>" and "unknown <n>".
+*   latency         "latency <event> <count> <p50> <p99> <p99.9> <max>" in microseconds.
+*   watchdog        "watchdog <stalls> <drops> <failed installs>", the incidents of the hook.
+*   time            "time <ms>", the default time of chatter.
+*   time <ms>       Change the default time of chatter, the keys with
+*                   their own time in the configuration keep it.
+*   reload          Read the configuration file again.
+*   debug           "debug on" or "debug off".
+*   debug on|off    Turn the debug output on or off.
+*   help
+*/
+class ControlProtocol
+{
+    ControlProtocol(const ControlProtocol&) = delete;
+    ControlProtocol& operator=(const ControlProtocol&) = delete;
+
+public:
+    explicit ControlProtocol(ControlTarget& target);
+
+    // Response to one request, each line ends with a new line.
+    std::string handle(const std::string& request);
+
+    // True for the last line of a response.
+    static bool isLastLine(const std::string& line);
+
+private:
+    std::string stats() const;
+    std::string latency() const;
+    std::string watchdog() const;
+
+    ControlTarget& m_target;
+};
+
+#endif // KEYCHATTERING_CONTROLPROTOCOL_H_
@@ -0,0 +1,75 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_CONTROLSERVER_H_
+#define KEYCHATTERING_CONTROLSERVER_H_
+
+#include "ControlProtocol.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/*
+* Local control endpoint of a running program: a Unix domain socket,
+* or a named pipe on Windows (\\.\pipe\<name>). The server has its own
+* thread, serving one client at a time with the ControlProtocol, so the
+* hook never waits for it. The requests longer than maxRequestSize
+* close the connection.
+*/
+class ControlServer
+{
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+public:
+    static const std::size_t maxRequestSize = 1024;
+
+    explicit ControlServer(ControlTarget& target);
+    ~ControlServer();
+
+    bool start(const std::string& endpoint, std::string& error);
+    void stop();
+    bool isRunning() const;
+
+private:
+    void run();
+    void serveClient();
+    bool handleInput(const char* data, std::size_t size, std::string& request);
+
+    ControlProtocol m_protocol;
+    std::atomic<bool> m_isRunning;
+    std::thread m_thread;
+    std::string m_endpoint;
+#ifdef _WIN32
+    void* m_pipe;
+    std::atomic<unsigned long> m_threadId;
+#else
+    int m_socket;
+    int m_client;
+    int m_wakeUpPipe[2];
+#endif
+};
+
+// The name of a named pipe is prefixed by \\.\pipe\ if needed.
+std::string controlEndpoint(const std::string& name);
+
+// Send one request to a control endpoint and read the whole response.
+bool sendControlRequest(const std::string& endpoint, const std::string& request, std::string& response, std::string& error);
+
+#endif // KEYCHATTERING_CONTROLSERVER_H_
@@ -0,0 +1,98 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_DEBUGLOG_H_
+#define KEYCHATTERING_DEBUGLOG_H_
+
+#include "ChatterEngine.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+enum class DebugRecordType : std::uint8_t
+{
+    Chatter,        // A press has been blocked.
+    ReleaseFailed   // A delayed release could not be sent.
+};
+
+// Fixed size binary record of a debug message.
+struct DebugRecord
+{
+    ChatterTime time;
+    ChatterTime timeSinceLastPress;
+    unsigned long key;
+    DebugRecordType type;
+    ChatterDecision decision;
+};
+
+// Thread writing the records. Each one has its own ring buffer.
+enum class DebugLogSource
+{
+    Hook,
+    ReleaseScheduler
+};
+
+/*
+* Asynchronous debug output. The threads filtering the keys only push
+* a fixed size record into a lock-free ring buffer, a background thread
+* format and write them. When a ring is full, the record is dropped
+* and counted, the producer never waits for the output.
+* After a stall, the stalled hook thread and the new one may log at the
+* same time: each ring is claimed by its producer with an atomic flag,
+* and a record finding it already claimed is dropped and counted too.
+*/
+class DebugLog
+{
+    DebugLog(const DebugLog&) = delete;
+    DebugLog& operator=(const DebugLog&) = delete;
+
+public:
+    static const std::size_t sourceCount = 2;
+    static const std::size_t ringCapacity = 1024;
+
+    explicit DebugLog(std::ostream& stream);
+    ~DebugLog();
+
+    bool log(DebugLogSource source, const DebugRecord& record);
+    std::uint64_t droppedCount() const;
+    void stop();
+
+private:
+    void run();
+    bool isEmpty() const;
+    void writeRecords();
+    void writeRecord(const DebugRecord& record);
+
+    std::ostream& m_stream;
+    SpscRing<DebugRecord, ringCapacity> m_rings[sourceCount];
+    std::atomic<bool> m_isPushing[sourceCount];
+    std::atomic<std::uint64_t> m_droppedCount;
+    std::uint64_t m_reportedDroppedCount;
+    std::atomic<bool> m_isWriterSleeping;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_isRunning;
+    std::thread m_thread;
+};
+
+#endif // KEYCHATTERING_DEBUGLOG_H_
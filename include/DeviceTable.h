@@ -0,0 +1,78 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_DEVICETABLE_H_
+#define KEYCHATTERING_DEVICETABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Identifier of the keyboard sending a key event (Raw Input handle, evdev device number...).
+typedef std::uint64_t DeviceId;
+
+// The device of the events whose device is not known.
+const DeviceId defaultDevice = 0;
+
+/*
+* Give to each device one of a fixed number of tables.
+* The tables are given on the first event of a device and given back
+* when the device is removed. The devices are found with an open
+* addressing hash table, four times larger than the number of tables,
+* so a lookup is O(1) and never allocates. The default device always
+* owns the first table.
+*/
+class DeviceTable
+{
+    DeviceTable(const DeviceTable&) = delete;
+    DeviceTable& operator=(const DeviceTable&) = delete;
+
+    struct Entry
+    {
+        DeviceId device;
+        std::int32_t table;
+    };
+
+public:
+    static const std::size_t noTable = static_cast<std::size_t>(-1);
+
+    explicit DeviceTable(std::size_t tableCount);
+
+    // Table of the device, noTable if the device has none.
+    std::size_t find(DeviceId device) const;
+    // Table of the device, a free one if the device has none yet (isNew is then true).
+    // Return noTable if every table is already used.
+    std::size_t acquire(DeviceId device, bool& isNew);
+    // Give back the table of the device.
+    bool release(DeviceId device);
+
+    DeviceId device(std::size_t table) const;
+    bool isUsed(std::size_t table) const;
+    std::size_t tableCount() const;
+    std::size_t usedCount() const;
+
+private:
+    std::size_t position(DeviceId device) const;
+
+    std::vector<Entry> m_entries;
+    std::vector<DeviceId> m_devices;
+    std::vector<std::size_t> m_freeTables;
+    std::vector<bool> m_isUsed;
+};
+
+#endif // KEYCHATTERING_DEVICETABLE_H_
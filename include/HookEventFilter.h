@@ -0,0 +1,58 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_HOOKEVENTFILTER_H_
+#define KEYCHATTERING_HOOKEVENTFILTER_H_
+
+#include "DebugLog.h"
+#include "HookWatchdog.h"
+#include "KeyEventRecording.h"
+#include "ReleaseScheduler.h"
+
+#include <atomic>
+
+/*
+* The work of the keyboard hook for one event: the watchdog is told of
+* the callback, the engine decides through the release scheduler, the
+* blocked presses are written to the debug log when it is enabled and
+* every event to the recording when it is open. Shared by KeyPressData
+* and the benchmark, so the path measured is the one of the program.
+* It never allocates nor waits for the threads writing the outputs.
+*/
+class HookEventFilter
+{
+    HookEventFilter(const HookEventFilter&) = delete;
+    HookEventFilter& operator=(const HookEventFilter&) = delete;
+
+public:
+    HookEventFilter(ReleaseScheduler& releaseScheduler, HookWatchdog& hookWatchdog, DebugLog& debugLog,
+        KeyEventRecorder& recorder, const std::atomic<bool>& isDebugEnabled);
+
+    // The time is the one of the event read by the hook, so the clock is read once per event.
+    // An own release is a delayed release sent by the program, injected too.
+    ChatterDecision filter(unsigned long key, bool isPressed, bool isInjected, bool isOwnRelease, ChatterTime time);
+
+private:
+    ReleaseScheduler& m_releaseScheduler;
+    HookWatchdog& m_hookWatchdog;
+    DebugLog& m_debugLog;
+    KeyEventRecorder& m_recorder;
+    const std::atomic<bool>& m_isDebugEnabled;
+};
+
+#endif // KEYCHATTERING_HOOKEVENTFILTER_H_
@@ -0,0 +1,141 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_HOOKWATCHDOG_H_
+#define KEYCHATTERING_HOOKWATCHDOG_H_
+
+#include "ChatterClock.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+/*
+* The keyboard hook watched by a HookWatchdog: the low level keyboard
+* hook of the program on Windows, a simulated hook elsewhere.
+* The methods are called by the thread of the watchdog.
+*/
+class WatchedHook
+{
+public:
+    virtual ~WatchedHook();
+
+    // Install the hook again on a new thread. The previous hook is removed,
+    // its thread exits after the callback in progress.
+    virtual bool reinstall() = 0;
+    // Send an event only seen by the hook, answered by HookWatchdog::answerProbe.
+    virtual void probe() = 0;
+};
+
+enum class HookIncident
+{
+    Stall,          // A callback lasted long enough to be dropped by the system.
+    Drop,           // The hook did not answer the probe sent after a doubt, the system dropped it.
+    FailedInstall   // The hook could not be installed again.
+};
+
+struct HookWatchdogSettings
+{
+    ChatterTime hookTimeout;    // A callback slower than this is dropped by the system.
+};
+
+/*
+* Watchdog of a low level keyboard hook. Windows silently removes a hook
+* whose callback is slower than the LowLevelHooksTimeout of the system.
+* The hook calls enterCallback and leaveCallback around each callback:
+* a callback still running after half of the timeout is a stall, the
+* hook is installed again on a fresh thread before the next events.
+* A hook can also be dropped without a visible stall, so the watchdog
+* sends one probe through the hook when a callback gives a reason to
+* doubt it: a callback running since a quarter of the timeout, a callback
+* starting half of the timeout after its event, or an event sent by the
+* program (expectCallback) not seen by the hook. The hook is installed
+* again if the probe is not answered in time, and is not probed again
+* until the next doubt.
+* The thread of the watchdog checks the callbacks four times per hook
+* timeout while the keyboard is used, and sleeps without timeout while it
+* is idle: the next callback or expected event wakes it up.
+* Every incident is counted and written to the log.
+*/
+class HookWatchdog
+{
+    HookWatchdog(const HookWatchdog&) = delete;
+    HookWatchdog& operator=(const HookWatchdog&) = delete;
+
+public:
+    static const std::size_t incidentTypeCount = 3;
+
+    HookWatchdog(const ChatterClock& clock, std::ostream& log);
+    ~HookWatchdog();
+
+    void start(WatchedHook& hook, const HookWatchdogSettings& settings);
+    void stop();
+    bool isRunning() const;
+
+    // Called by the hook, from any thread, without waiting for the watchdog.
+    void enterCallback(ChatterTime startTime);
+    void leaveCallback(ChatterTime startTime);
+    void answerProbe();
+    // Called before sending an event the hook must see, from any thread.
+    void expectCallback();
+
+    std::uint64_t incidentCount(HookIncident incident) const;
+    void print(std::ostream& stream) const;
+
+private:
+    void run();
+    void wakeUp();
+    ChatterTime check(ChatterTime now);
+    void reinstall(HookIncident incident, ChatterTime duration);
+
+    const ChatterClock& m_clock;
+    std::ostream& m_log;
+    WatchedHook* m_hook;
+    HookWatchdogSettings m_settings;
+
+    // Written by the hook.
+    std::atomic<ChatterTime::rep> m_callbackStartTime;
+    std::atomic<ChatterTime::rep> m_lastCallbackTime;
+    std::atomic<bool> m_isProbeAnswered;
+    std::atomic<bool> m_isIdle;
+    // Written by the threads sending events.
+    std::atomic<ChatterTime::rep> m_callbackBeforeEvent;
+    std::atomic<bool> m_isCallbackExpected;
+
+    // State of the thread of the watchdog.
+    ChatterTime::rep m_lastSeenCallback;
+    ChatterTime::rep m_stalledCallback;
+    ChatterTime::rep m_slowCallback;
+    ChatterTime::rep m_callbackBeforeWait;
+    ChatterTime m_lastAliveTime;
+    ChatterTime m_probeTime;
+    ChatterTime m_expectTime;
+    bool m_isProbing;
+    bool m_isWaitingCallback;
+
+    std::atomic<std::uint64_t> m_incidents[incidentTypeCount];
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::atomic<bool> m_isRunning;
+    std::thread m_thread;
+};
+
+#endif // KEYCHATTERING_HOOKWATCHDOG_H_
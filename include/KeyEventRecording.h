@@ -0,0 +1,204 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_KEYEVENTRECORDING_H_
+#define KEYCHATTERING_KEYEVENTRECORDING_H_
+
+#include "ChatterEngine.h"
+#include "KeyEventTrace.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+const std::uint32_t keyEventRecordingMagic = 0x524B434B; // "KCKR"
+const std::uint16_t keyEventRecordingVersion = 1;
+
+/*
+* Binary recording of the key events seen by the hook and of the decisions
+* of the engine. The file is only appended to: a header, then the records,
+* so a recording interrupted at any time is still readable up to its last
+* complete record. Each record is:
+*   varint  time since the previous record, in microseconds, zigzag encoded
+*           (the first record counts from the start of the clock)
+*   varint  virtual key code
+*   byte    flags, see KeyEventRecordFlag
+*   byte    decision of the engine, see ChatterDecision
+*   varint  device, only with KeyEventRecordFlag::Device
+* A varint is 7 bits per byte, the low bits first, the high bit set on all
+* the bytes but the last one. A typing event takes 4 or 5 bytes.
+* The header has a fixed layout, in the byte order of the machine
+* (little endian on the supported platforms).
+*/
+struct KeyEventRecordingHeader
+{
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint16_t size;         // Size of the header, the records start after it.
+    std::int64_t startTime;     // Seconds since 1970-01-01 UTC.
+    std::uint32_t processId;
+    std::uint32_t timeUnit;     // Nanoseconds per tick of the times, 1000.
+    std::uint8_t reserved[8];
+};
+
+static_assert(sizeof(KeyEventRecordingHeader) == 32, "The layout of KeyEventRecordingHeader has changed.");
+
+enum class KeyEventRecordFlag : std::uint8_t
+{
+    Pressed = 1,    // A press, a release otherwise.
+    Injected = 2,   // Sent by a program, such as the releases of KeyChattering.
+    Device = 4,     // The device follows the decision.
+    OwnRelease = 8  // A delayed release sent by KeyChattering itself, also Injected.
+};
+
+// A key event and the decision of the engine.
+struct KeyEventRecord
+{
+    ChatterTime time;
+    DeviceId device;
+    unsigned long key;
+    bool isPressed;
+    bool isInjected;
+    bool isOwnRelease;
+    ChatterDecision decision;
+};
+
+/*
+* Write a recording. The hook only pushes a fixed size record into a
+* lock-free ring buffer, a background thread encodes them and writes
+* them by blocks of bufferSize bytes, or flushInterval after the first
+* record of a block. When the ring is full, the record is dropped and
+* counted, the hook never waits for the file. After a stall, the stalled
+* hook thread and the new one may record at the same time: the ring is
+* claimed by its producer with an atomic flag, and a record finding it
+* already claimed is dropped and counted too.
+*/
+class KeyEventRecorder
+{
+    KeyEventRecorder(const KeyEventRecorder&) = delete;
+    KeyEventRecorder& operator=(const KeyEventRecorder&) = delete;
+
+public:
+    static const std::size_t ringCapacity = 4096;
+    static const std::size_t bufferSize = 64 * 1024;
+
+    KeyEventRecorder();
+    ~KeyEventRecorder();
+
+    // Create (or overwrite) the file and start the writer.
+    bool open(const std::string& path, std::string& error);
+    // Write the remaining records and close the file.
+    void close();
+    bool isOpen() const;
+
+    bool record(const KeyEventRecord& record);
+    std::uint64_t recordedCount() const;
+    std::uint64_t droppedCount() const;
+    void print(std::ostream& stream) const;
+
+private:
+    void run();
+    void encodeRecords();
+    void writeBuffer();
+
+    std::ofstream m_file;
+    std::string m_path;
+    SpscRing<KeyEventRecord, ringCapacity> m_ring;
+    std::atomic<bool> m_isPushing;
+    std::vector<unsigned char> m_buffer;
+    std::chrono::steady_clock::time_point m_bufferTime;
+    ChatterTime m_lastTime;
+    std::atomic<std::uint64_t> m_recordedCount;
+    std::atomic<std::uint64_t> m_droppedCount;
+    std::atomic<bool> m_isWriterSleeping;
+    std::atomic<bool> m_isFailed;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_isRunning;
+    std::thread m_thread;
+};
+
+/*
+* A recording mapped into memory, read only. The records are decoded
+* straight from the mapping by a Cursor, without copying the file.
+*/
+class KeyEventRecordingFile
+{
+    KeyEventRecordingFile(const KeyEventRecordingFile&) = delete;
+    KeyEventRecordingFile& operator=(const KeyEventRecordingFile&) = delete;
+
+public:
+    class Cursor
+    {
+    public:
+        Cursor(const unsigned char* begin, const unsigned char* end);
+
+        // Decode the next record, false at the end of the records.
+        bool next(KeyEventRecord& record);
+        // The recording ends with an incomplete record, it was cut while written.
+        bool isTruncated() const;
+
+    private:
+        bool readVarint(std::uint64_t& value);
+
+        const unsigned char* m_position;
+        const unsigned char* m_end;
+        ChatterTime m_time;
+        bool m_isTruncated;
+    };
+
+    KeyEventRecordingFile();
+    ~KeyEventRecordingFile();
+
+    // Map an existing recording, its header is checked.
+    bool open(const std::string& path, std::string& error);
+    void close();
+    bool isOpen() const;
+
+    const KeyEventRecordingHeader& header() const;
+    Cursor records() const;
+
+    // True if the file starts with the magic of a recording.
+    static bool isRecording(const std::string& path);
+
+private:
+    bool map(const std::string& path, std::string& error);
+
+    const unsigned char* m_data;
+    std::size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_file;
+#endif
+};
+
+// Read the key events of a recording, the delayed releases sent by KeyChattering are skipped.
+// The events injected by the other programs, such as remapping tools, are kept.
+bool readKeyEventRecording(const std::string& path, std::vector<KeyEvent>& events, std::string& error);
+
+#endif // KEYCHATTERING_KEYEVENTRECORDING_H_
@@ -0,0 +1,48 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_KEYEVENTTRACE_H_
+#define KEYCHATTERING_KEYEVENTTRACE_H_
+
+#include "ChatterClock.h"
+#include "DeviceTable.h"
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// A key event recorded from a keyboard.
+struct KeyEvent
+{
+    ChatterTime time;
+    unsigned long key;
+    bool isPressed;
+    DeviceId device;
+};
+
+/*
+* Read a text trace of key events. Each line is made of the time of the
+* event in milliseconds, the virtual key code (decimal or 0x hexadecimal)
+* and "down" or "up", optionally followed by the device of the event,
+* so a trace can mix several keyboards. Empty lines and lines starting
+* with # are ignored. Example: "1523.250 0x41 down" or "1523.250 0x41 down 2".
+* Return false and fill error if a line cannot be parsed.
+*/
+bool readKeyEventTrace(std::istream& stream, std::vector<KeyEvent>& events, std::string& error);
+
+#endif // KEYCHATTERING_KEYEVENTTRACE_H_
@@ -19,31 +19,54 @@
 #ifndef KEYCHATTERING_KEYPRESSDATA_H_
 #define KEYCHATTERING_KEYPRESSDATA_H_
 
-#include <chrono>
-#include <vector>
 #include <memory>
-#include <mutex>
-#include <string>
-#include <thread>
 #include <atomic>
+#include <chrono>
+
+#include "ChatterEngine.h"
+#include "ConfigWatcher.h"
+#include "ControlServer.h"
+#include "DebugLog.h"
+#include "HookEventFilter.h"
+#include "HookWatchdog.h"
+#include "KeyEventRecording.h"
+#include "LatencyHistogram.h"
+#include "ReleaseScheduler.h"
+#include "StatisticsFile.h"
 
-class KeyPressData
+/*
+* Windows host of the chatter engine: it gives to the engine the
+* events received by the keyboard hook and releases the delayed
+* keys using SendInput, one call for the keys released together.
+* The decisions are counted into the statistics file given by --stats,
+* or into memory for the control endpoint. The configuration file is
+* read again each time it is written. The work of the hook for each
+* event is done by a HookEventFilter: the watchdog of the keyboard hook
+* is told of each callback, and with --record, the events and the
+* decisions are written into a binary recording by another thread.
+*/
+class KeyPressData : public ReleaseSink
 {
     KeyPressData(const KeyPressData&) = delete;
 
-    struct KeyPressInfo
+    // What the control endpoint can see and change, called by its thread
+    // and by the thread of the configuration watcher.
+    class Control : public ControlTarget
     {
-        unsigned long keyID;
-        std::chrono::time_point<std::chrono::system_clock> timeWhenPressed;
-        std::chrono::duration<double, std::milli> timeWhenPressedSinceTheStartingOfTheProgram;
-    };
+    public:
+        explicit Control(KeyPressData& keyPressData);
 
-    struct KeyReleaseInfo
-    {
-        unsigned long keyID;
-        std::chrono::time_point<std::chrono::system_clock> timeWhenPressed;
-        std::chrono::duration<double, std::milli> timeWhenPressedSinceTheStartingOfTheProgram;
-        bool isKeyPressedSinceRelease;
+        const ChatterStatistics* statistics() const override;
+        const HookLatency* hookLatency() const override;
+        const HookWatchdog* hookWatchdog() const override;
+        ChatterTime chatterTime() const override;
+        void setChatterTime(ChatterTime time) override;
+        bool reloadConfig(std::string& error) override;
+        bool isDebugEnabled() const override;
+        bool enableDebug(bool enable) override;
+
+    private:
+        KeyPressData& m_keyPressData;
     };
 
     KeyPressData();
@@ -52,44 +75,44 @@ public:
 
     static KeyPressData* createInstance();
     static KeyPressData* instance();
-    static std::string keyName(unsigned long keyNumber);
 
-    bool isKeyPressChatter(unsigned long key);
-    bool isKeyReleaseChatter(unsigned long key);
+    bool isKeyChatter(unsigned long key, bool isPressed, bool isInjected, bool isOwnRelease,
+        std::chrono::steady_clock::time_point eventTime);
+    void releaseKey(unsigned long key) override;
+    void releaseKeys(const unsigned long* keys, std::size_t count) override;
+    HookLatency& hookLatency();
+    HookWatchdog& hookWatchdog();
+    KeyEventRecorder& recorder();
 
-    void setChatterTime(int msec);
+    void setChatterTime(double msec);
+    void setChatterTime(ChatterTime time);
+    bool enableAdaptiveChatterTime(double minimumMsec, double maximumMsec);
+    void setConfig(const ChatterConfig& config);
+    bool loadConfig(const std::string& path, std::string& error);
+    bool openStatistics(const std::string& path, std::string& error);
+    bool startRecording(const std::string& path, std::string& error);
+    bool startControl(const std::string& name, std::string& error);
     void enableDebug(bool enable);
     void waitForThreadToFinish();
-    void removingFinishedThread();
 
 private:
-    int findKeyPressPos(unsigned long key) const;
-    int findKeyReleasePos(unsigned long key) const;
-    const KeyPressInfo getKeyPressInfo(int pos) const;
-    const KeyReleaseInfo getKeyReleaseInfo(int pos) const;
-    void appendKeyPressInfo(const KeyPressInfo& keyInfo);
-    void appendKeyReleaseInfo(const KeyReleaseInfo& keyInfo);
-    void setKeyPressInfoTime(int pos, std::chrono::time_point<std::chrono::system_clock> time);
-    void setKeyReleaseInfoTime(int pos, std::chrono::time_point<std::chrono::system_clock> time);
-    void setKeyReleaseIsKeyPressedSinceRelease(int pos, bool value);
-    /*int keyPressInfoSize() const;
-    int keyReleaseInfoSize() const;*/
-    void waitBeforeReleasingKey(unsigned long key, const std::chrono::duration<double, std::milli> timeWhenKeyRelease);
-    void setKeyPressTimeSinceStartingOfTheProgram(int pos, const std::chrono::duration<double, std::milli>& time);
-    void setKeyReleaseTimeSinceStartingOfTheProgram(int pos, const std::chrono::duration<double, std::milli>& time);
-
     static std::unique_ptr<KeyPressData> _instance;
 
-    std::vector<KeyPressInfo> m_keyPressInfo;
-    std::vector<KeyReleaseInfo> m_keyReleaseInfo;
-    mutable std::mutex m_keyPressMutex;
-    mutable std::mutex m_keyReleaseMutex;
-    std::chrono::duration<double, std::micro> m_timeOfChatter;
-    std::chrono::time_point<std::chrono::system_clock> m_timeSinceProgramStarted;
-    std::vector<std::thread> m_threadReleaseKeys;
-    std::mutex m_threadReleaseKeysMutex;
-
+    SteadyChatterClock m_clock;
+    StatisticsFile m_statisticsFile;
+    ChatterStatistics m_localStatistics;
+    ChatterEngine m_engine;
     std::atomic<bool> m_isDebugEnabled;
+    HookLatency m_hookLatency;
+    HookWatchdog m_hookWatchdog;
+    DebugLog m_debugLog;
+    KeyEventRecorder m_recorder;
+    ReleaseScheduler m_releaseScheduler;
+    HookEventFilter m_hookEventFilter;
+    std::string m_configPath;
+    Control m_control;
+    ControlServer m_controlServer;
+    ConfigWatcher m_configWatcher;
 };
 
 #endif // KEYCHATTERING_KEYPRESSDATA_H_
\ No newline at end of file
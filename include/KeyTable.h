@@ -0,0 +1,90 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef KEYCHATTERING_KEYTABLE_H_
+#define KEYCHATTERING_KEYTABLE_H_
+
+#include <cstdint>
+#include <cstddef>
+
+// Family of a virtual key code.
+enum class KeyCategory : std::uint8_t
+{
+    Unknown,
+    Mouse,
+    Modifier,
+    Lock,
+    Control,
+    Navigation,
+    Editing,
+    Alpha,
+    Digit,
+    Function,
+    Numpad,
+    Oem,
+    Media,
+    Ime,
+    System
+};
+
+// Number of key categories.
+const std::size_t keyCategoryCount = static_cast<std::size_t>(KeyCategory::System) + 1;
+
+// Properties of a virtual key code.
+enum KeyFlag : std::uint8_t
+{
+    KeyFlagNone = 0,
+    KeyFlagToggle = 1 << 0, // Lock keys (caps lock, num lock, scroll lock).
+    KeyFlagSided = 1 << 1, // Left or right variant of a modifier.
+    KeyFlagGeneric = 1 << 2, // Modifier without side (shift, control, alt).
+    KeyFlagPrintable = 1 << 3 // Produce a character.
+};
+
+// Description of a virtual key code. The name is a static string.
+struct KeyDescription
+{
+    const char* name;
+    KeyCategory category;
+    std::uint8_t flags;
+};
+
+// Number of entries in the key table, one for each virtual key code.
+const std::size_t keyTableSize = 256;
+
+// Description of a virtual key code. Codes outside of the table are unknown.
+const KeyDescription& keyDescription(unsigned long keyNumber);
+
+// Return the name of a virtual key code, "unknown" when the code has no name.
+const char* keyName(unsigned long keyNumber);
+
+// Return the category of a virtual key code.
+KeyCategory keyCategory(unsigned long keyNumber);
+
+// Return the flags of a virtual key code.
+std::uint8_t keyFlags(unsigned long keyNumber);
+
+// Find a virtual key code from its name (case insensitive) or from its number
+// ("0x41"). The names "0" to "9" are the digit keys. Return false if the name is unknown.
+bool keyFromName(const char* name, unsigned long& keyNumber);
+
+// Return the name of a category.
+const char* keyCategoryName(KeyCategory category);
+
+// Find a category from its name (case insensitive). Return false if unknown.
+bool keyCategoryFromName(const char* name, KeyCategory& category);
+
+#endif // KEYCHATTERING_KEYTABLE_H_
@@ -21,6 +21,15 @@
 
 #include <windows.h>
 
+// Event sent by the hook watchdog to check the hook is alive,
+// a release of an unassigned key discarded by the hook.
+const WORD hookProbeKey = 0xFF;
+const ULONG_PTR hookProbeTag = 0x4B434850;
+
+// Tag of the delayed releases sent by the program, told apart from
+// the events injected by the other programs in the recording.
+const ULONG_PTR releaseTag = 0x4B43524C;
+
 LRESULT CALLBACK keyHookProc(
     int nCode,
     WPARAM wParam,
@@ -0,0 +1,91 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_LATENCYHISTOGRAM_H_
+#define KEYCHATTERING_LATENCYHISTOGRAM_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/*
+* Histogram of durations with logarithmic buckets, in the spirit
+* of HdrHistogram: each power of two is split into 16 linear buckets,
+* so any value is known with a relative error below 1/16.
+* Recording is one relaxed atomic increment and can be done from any thread.
+*/
+class LatencyHistogram
+{
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+public:
+    static const std::size_t subBucketBits = 4;
+    static const std::size_t subBucketCount = 1 << subBucketBits;
+    // Up to 2^40 nanoseconds, about 18 minutes.
+    static const std::size_t bucketCount = (40 - subBucketBits + 2) * subBucketCount;
+
+    LatencyHistogram();
+
+    void record(std::chrono::nanoseconds duration);
+    void reset();
+
+    std::uint64_t count() const;
+    std::chrono::nanoseconds max() const;
+    std::chrono::nanoseconds valueAtPercentile(double percentile) const;
+
+private:
+    static std::size_t bucketIndex(std::uint64_t value);
+    static std::uint64_t bucketHighestValue(std::size_t index);
+
+    std::atomic<std::uint64_t> m_buckets[bucketCount];
+    std::atomic<std::uint64_t> m_max;
+};
+
+enum class HookEventType
+{
+    Press,
+    Release,
+    Blocked,
+    Passed
+};
+
+/*
+* Time spent in the keyboard hook callback, kept for each type of event.
+* Each event is recorded as a press or a release, and as blocked or passed.
+*/
+class HookLatency
+{
+    HookLatency(const HookLatency&) = delete;
+    HookLatency& operator=(const HookLatency&) = delete;
+
+public:
+    static const std::size_t eventTypeCount = 4;
+
+    HookLatency();
+
+    void record(bool isPressed, bool isBlocked, std::chrono::nanoseconds duration);
+    const LatencyHistogram& histogram(HookEventType type) const;
+    void print(std::ostream& stream) const;
+
+private:
+    LatencyHistogram m_histograms[eventTypeCount];
+};
+
+#endif // KEYCHATTERING_LATENCYHISTOGRAM_H_
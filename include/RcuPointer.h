@@ -0,0 +1,129 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_RCUPOINTER_H_
+#define KEYCHATTERING_RCUPOINTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+* Pointer to an immutable value, read without lock and replaced by
+* publishing a new value with one atomic pointer swap (read-copy-update).
+* The readers are a single thread at a time (the other threads use value()
+* instead, as the writers do): a ReadSection loads the
+* current value and, when it ends, tells which generation it has used.
+* The loaded generations only grow, so a replaced value older than the
+* generation used by the last section can no longer be seen and is
+* deleted by the next publish. Reading costs two plain loads and one
+* plain store, the writers are serialized by a mutex and never wait
+* for the reader. The read sections are not nested.
+*/
+template<typename T>
+class RcuPointer
+{
+    RcuPointer(const RcuPointer&) = delete;
+    RcuPointer& operator=(const RcuPointer&) = delete;
+
+    struct Node
+    {
+        T value;
+        std::uint64_t generation;
+    };
+
+public:
+    class ReadSection
+    {
+        ReadSection(const ReadSection&) = delete;
+        ReadSection& operator=(const ReadSection&) = delete;
+
+    public:
+        explicit ReadSection(const RcuPointer& pointer) :
+            m_pointer(pointer),
+            m_node(pointer.m_current.load(std::memory_order_acquire))
+        {}
+
+        ~ReadSection()
+        {
+            m_pointer.m_readGeneration.store(m_node->generation, std::memory_order_release);
+        }
+
+        const T& operator*() const { return m_node->value; }
+        const T* operator->() const { return &m_node->value; }
+        // Never zero, so zero can mean never read.
+        std::uint64_t generation() const { return m_node->generation; }
+
+    private:
+        const RcuPointer& m_pointer;
+        const Node* m_node;
+    };
+
+    explicit RcuPointer(const T& value) :
+        m_current(new Node{value, 1}),
+        m_readGeneration(1),
+        m_generation(1)
+    {}
+
+    ~RcuPointer()
+    {
+        delete m_current.load();
+        for (std::size_t i = 0; i < m_retired.size(); i++)
+            delete m_retired[i];
+    }
+
+    // Copy the current value, change it and publish the copy.
+    template<typename Update>
+    void update(Update change)
+    {
+        std::lock_guard<std::mutex> guard(m_writeMutex);
+        std::unique_ptr<Node> node(new Node{m_current.load(std::memory_order_acquire)->value, ++m_generation});
+        change(node->value);
+        m_retired.push_back(m_current.exchange(node.release(), std::memory_order_acq_rel));
+
+        // Delete the values the reader has gone past.
+        const std::uint64_t readGeneration = m_readGeneration.load(std::memory_order_acquire);
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < m_retired.size(); i++)
+        {
+            if (m_retired[i]->generation < readGeneration)
+                delete m_retired[i];
+            else
+                m_retired[kept++] = m_retired[i];
+        }
+        m_retired.resize(kept);
+    }
+
+    // A copy of the current value, for the writers and the other threads.
+    T value() const
+    {
+        std::lock_guard<std::mutex> guard(m_writeMutex);
+        return m_current.load(std::memory_order_acquire)->value;
+    }
+
+private:
+    std::atomic<const Node*> m_current;
+    mutable std::atomic<std::uint64_t> m_readGeneration;
+    mutable std::mutex m_writeMutex;
+    std::uint64_t m_generation;
+    std::vector<const Node*> m_retired;
+};
+
+#endif // KEYCHATTERING_RCUPOINTER_H_
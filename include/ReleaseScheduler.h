@@ -0,0 +1,129 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_RELEASESCHEDULER_H_
+#define KEYCHATTERING_RELEASESCHEDULER_H_
+
+#include "ChatterEngine.h"
+#include "SpscRing.h"
+#include "TimerWheel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* Front of a ChatterEngine for a keyboard hook, with one long-lived thread
+* sending the delayed releases to the sink when they are due.
+* The engine belongs to the thread giving the events: the hook never takes
+* a lock nor waits for the thread. Each delayed release is pushed into a
+* lock-free ring buffer with a generation, and the thread keeps it in its
+* own timer wheel. A release is claimed with one compare and swap of the
+* state of its key: by the thread to send it when it is due, or by the hook
+* when the engine cancels it. The engine learns the due releases from its
+* own wheel at the next event, so both stay in step without sharing data.
+* While there is no pending release, the thread sleeps on a condition
+* variable and never wakes up. The hook only takes the mutex to wake the
+* thread up for a release due sooner than expected; the thread holds it
+* only while it goes to sleep, never while it works.
+* The releases due within the same batch time (aligned on multiples of it)
+* are sent together, at the end of the batch, in one call to the sink
+* for each device.
+* The events come from one thread at a time: after a stall, the events
+* of a second hook thread pass unfiltered while the first one is still
+* inside the engine.
+*/
+class ReleaseScheduler
+{
+    ReleaseScheduler(const ReleaseScheduler&) = delete;
+    ReleaseScheduler& operator=(const ReleaseScheduler&) = delete;
+
+    // A delayed release given by the hook to the thread.
+    struct ScheduledRelease
+    {
+        DeviceId device;
+        unsigned long key;
+        std::size_t slot;
+        ChatterTime releaseTime;
+        std::uint64_t generation;
+    };
+
+public:
+    static const std::size_t ringCapacity = 1024;
+
+    ReleaseScheduler(ChatterEngine& engine, const ChatterClock& clock, ReleaseSink& sink,
+        ChatterTime batchTime = std::chrono::milliseconds(1));
+    ~ReleaseScheduler();
+
+    // Called by the hook.
+    ChatterResult processKeyEvent(unsigned long key, bool isPressed);
+    ChatterResult processKeyEvent(unsigned long key, bool isPressed, ChatterTime time);
+    ChatterResult processKeyEvent(DeviceId device, unsigned long key, bool isPressed, ChatterTime time);
+
+    // Thread safe.
+    void setChatterTime(ChatterTime time);
+    ChatterTime chatterTime() const;
+    void setConfig(const ChatterConfig& config);
+    void setBatchTime(ChatterTime batchTime);
+
+    // Before the first event.
+    bool enableAdaptiveChatterTime(ChatterTime minimum, ChatterTime maximum);
+    void setStatistics(ChatterStatistics* statistics);
+    void stop();
+
+private:
+    bool scheduleRelease(DeviceId device, unsigned long key, std::size_t slot, ChatterTime releaseTime);
+    void cancelRelease(std::size_t slot);
+    void run();
+    void takeScheduledReleases();
+    void sendDueReleases(ChatterTime now);
+    ChatterTime batchEndTime(ChatterTime time) const;
+
+    ChatterEngine& m_engine;
+    const ChatterClock& m_clock;
+    ReleaseSink& m_sink;
+    const std::size_t m_slotCount;
+
+    // State of the hook.
+    std::atomic<bool> m_isProcessing;
+    std::uint64_t m_generation;
+    std::unique_ptr<bool[]> m_isScheduled;
+    ReleaseBuffer m_engineReleases;
+
+    // Shared, a state is the generation of the release of the slot shifted by one, plus one when claimed.
+    SpscRing<ScheduledRelease, ringCapacity> m_scheduledReleases;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> m_releaseStates;
+    std::atomic<ChatterTime::rep> m_wakeUpTime;
+    std::atomic<ChatterTime::rep> m_batchTime;
+
+    // State of the thread.
+    std::vector<ScheduledRelease> m_pendingReleases;
+    TimerWheel m_wheel;
+    std::vector<std::size_t> m_dueSlots;
+    ReleaseBuffer m_dueKeys;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_isRunning;
+    std::thread m_thread;
+};
+
+#endif // KEYCHATTERING_RELEASESCHEDULER_H_
@@ -0,0 +1,70 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_RELEASESINK_H_
+#define KEYCHATTERING_RELEASESINK_H_
+
+#include "DeviceTable.h"
+
+#include <cstddef>
+#include <vector>
+
+/*
+* Output of the chatter engine: receive the key releases
+* that were delayed and must now be sent to the system.
+* The releases due together are given at once to releaseKeys,
+* a sink able to send them in one call overrides it. The releases
+* of each device are given apart to releaseDeviceKeys, a sink that
+* does not care about the devices only overrides releaseKeys.
+*/
+class ReleaseSink
+{
+public:
+    virtual ~ReleaseSink();
+    virtual void releaseKey(unsigned long key) = 0;
+    // By default, the keys are released one by one.
+    virtual void releaseKeys(const unsigned long* keys, std::size_t count);
+    // By default, the device is ignored.
+    virtual void releaseDeviceKeys(DeviceId device, const unsigned long* keys, std::size_t count);
+};
+
+// Sink keeping the released keys, and their device, into a fixed size buffer.
+// It also records the releases of the engine, one batch after the other.
+class ReleaseBuffer : public ReleaseSink
+{
+public:
+    // A key of a device can only be pending once, so 256 keys for each device.
+    explicit ReleaseBuffer(std::size_t capacity = 256);
+    void releaseKey(unsigned long key) override;
+    void releaseKeys(const unsigned long* keys, std::size_t count) override;
+    void releaseDeviceKeys(DeviceId device, const unsigned long* keys, std::size_t count) override;
+
+    std::size_t size() const;
+    unsigned long at(std::size_t i) const;
+    DeviceId deviceAt(std::size_t i) const;
+    const unsigned long* keys() const;
+    void clear();
+
+private:
+    // The capacity is reserved at construction, the buffers never grow.
+    std::vector<unsigned long> m_keys;
+    std::vector<DeviceId> m_devices;
+    std::size_t m_capacity;
+};
+
+#endif // KEYCHATTERING_RELEASESINK_H_
@@ -0,0 +1,84 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_SPSCRING_H_
+#define KEYCHATTERING_SPSCRING_H_
+
+#include <atomic>
+#include <cstddef>
+
+/*
+* Bounded lock-free ring buffer with a single producer thread
+* and a single consumer thread. Pushing into a full ring fails
+* instead of waiting. Capacity must be a power of two.
+*/
+template<typename T, std::size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+public:
+    SpscRing() :
+        m_head(0),
+        m_tail(0)
+    {}
+
+    // Called by the producer thread only.
+    bool push(const T& value)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        m_values[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Called by the consumer thread only.
+    bool pop(T& value)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+
+        value = m_values[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // The indexes are 64 bytes apart, so the producer and the consumer
+    // never write into the same cache line. Padding is used instead of
+    // alignas, which plain new does not honour before C++17.
+    std::atomic<std::size_t> m_head;
+    char m_headPadding[64];
+    std::atomic<std::size_t> m_tail;
+    char m_tailPadding[64];
+    T m_values[Capacity];
+};
+
+#endif // KEYCHATTERING_SPSCRING_H_
@@ -0,0 +1,63 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_STATISTICSFILE_H_
+#define KEYCHATTERING_STATISTICSFILE_H_
+
+#include "ChatterStatistics.h"
+
+#include <string>
+
+/*
+* Memory mapped file holding a ChatterStatistics.
+* The program filtering the keys creates the file and gives the mapped
+* statistics to the engine, the monitoring tools open it read only.
+* The file is kept mapped until close or the destruction of the object.
+*/
+class StatisticsFile
+{
+    StatisticsFile(const StatisticsFile&) = delete;
+    StatisticsFile& operator=(const StatisticsFile&) = delete;
+
+public:
+    StatisticsFile();
+    ~StatisticsFile();
+
+    // Create (or overwrite) the file with empty counters.
+    bool create(const std::string& path, std::string& error);
+    // Open an existing file read only, its header is checked.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    bool isOpen() const;
+    ChatterStatistics* statistics();
+    const ChatterStatistics* statistics() const;
+
+private:
+    bool map(const std::string& path, bool isWritable, std::string& error);
+
+    void* m_data;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_file;
+#endif
+};
+
+#endif // KEYCHATTERING_STATISTICSFILE_H_
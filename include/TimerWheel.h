@@ -0,0 +1,73 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_TIMERWHEEL_H_
+#define KEYCHATTERING_TIMERWHEEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* Hashed timer wheel storing at most one deadline per slot.
+* A slot is identified by a small integer (the key code), so the
+* memory used by the wheel is fixed at construction whatever the number
+* of deadlines scheduled. Scheduling and cancelling are O(1).
+* Times are expressed in microseconds. The wheel is not thread safe.
+*/
+class TimerWheel
+{
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    struct Slot
+    {
+        std::int64_t deadline;
+        std::int32_t previous;
+        std::int32_t next;
+        std::int32_t bucket;
+    };
+
+public:
+    TimerWheel(std::size_t slotCount, std::int64_t resolution, std::size_t bucketCount = 1024);
+
+    bool schedule(std::size_t slot, std::int64_t deadline);
+    bool cancel(std::size_t slot);
+    bool isPending(std::size_t slot) const;
+    bool isEmpty() const;
+    std::size_t pendingCount() const;
+    std::size_t slotCount() const;
+
+    bool nextDeadline(std::int64_t& deadline) const;
+    std::size_t popDue(std::int64_t now, std::size_t* slots, std::size_t maxSlots);
+
+private:
+    std::size_t bucketOfTick(std::int64_t tick) const;
+    void link(std::size_t slot, std::size_t bucket);
+    void unlink(std::size_t slot);
+    bool findNonEmptyBucket(std::size_t from, std::size_t& bucket) const;
+
+    std::vector<Slot> m_slots;
+    std::vector<std::int32_t> m_buckets;
+    std::vector<std::uint64_t> m_bucketBitmap;
+    std::int64_t m_resolution;
+    std::int64_t m_currentTick;
+    std::size_t m_pendingCount;
+};
+
+#endif // KEYCHATTERING_TIMERWHEEL_H_
@@ -0,0 +1,86 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KEYCHATTERING_WORKSTEALINGPOOL_H_
+#define KEYCHATTERING_WORKSTEALINGPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*
+* Pool of threads running a batch of independent tasks, numbered from 0.
+* The tasks of a batch are split into one block per thread, each thread
+* runs its own tasks from the end of its queue, then takes the tasks
+* left at the front of the queues of the other threads, so a thread
+* given slower tasks is helped by the ones already done.
+* Each queue has its own mutex, only a thread looking for work takes
+* the mutex of another queue. The tasks must not add tasks to the pool.
+* run is called by one thread at a time, it returns when the whole
+* batch is done.
+*/
+class WorkStealingPool
+{
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+public:
+    // With 0 threads, one thread per core.
+    explicit WorkStealingPool(std::size_t threadCount = 0);
+    ~WorkStealingPool();
+
+    std::size_t threadCount() const;
+    // Call task(i) for each i below taskCount on the threads of the pool.
+    void run(std::size_t taskCount, const std::function<void(std::size_t)>& task);
+    // Number of tasks run by another thread than the one they were given to.
+    std::uint64_t stolenCount() const;
+
+private:
+    // Queue of a thread. The queues are 64 bytes apart, padding is used
+    // instead of alignas, which plain new does not honour before C++17.
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+        std::thread thread;
+        char padding[64];
+    };
+
+    void work(std::size_t worker);
+    bool takeTask(std::size_t worker, std::size_t& task);
+
+    std::size_t m_threadCount;
+    std::unique_ptr<Worker[]> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_batchCondition;
+    std::condition_variable m_doneCondition;
+    const std::function<void(std::size_t)>* m_task; // Task of the current batch, nullptr between batches.
+    std::uint64_t m_batch;
+    std::size_t m_remainingTasks;
+    std::size_t m_busyWorkers;
+    bool m_isRunning;
+    std::atomic<std::uint64_t> m_stolenCount;
+};
+
+#endif // KEYCHATTERING_WORKSTEALINGPOOL_H_
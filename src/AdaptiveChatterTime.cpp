@@ -0,0 +1,127 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "AdaptiveChatterTime.h"
+
+const std::size_t AdaptiveChatterTime::bucketCount;
+const std::uint16_t AdaptiveChatterTime::minimumSampleCount;
+const std::uint16_t AdaptiveChatterTime::updatePeriod;
+const std::uint16_t AdaptiveChatterTime::decayPeriod;
+
+AdaptiveChatterTime::AdaptiveChatterTime(std::size_t keyCount) :
+    m_keys(keyCount),
+    m_minimum(std::chrono::milliseconds(5)),
+    m_maximum(std::chrono::milliseconds(50)),
+    m_bucketWidth(m_maximum / bucketCount)
+{
+    reset();
+}
+
+void AdaptiveChatterTime::setBounds(ChatterTime minimum, ChatterTime maximum)
+{
+    // The buckets must be at least one microsecond wide.
+    if (maximum < ChatterTime(static_cast<ChatterTime::rep>(bucketCount)))
+        maximum = ChatterTime(static_cast<ChatterTime::rep>(bucketCount));
+    if (minimum > maximum)
+        minimum = maximum;
+
+    m_minimum = minimum;
+    m_maximum = maximum;
+    m_bucketWidth = maximum / bucketCount;
+    reset();
+}
+
+ChatterTime AdaptiveChatterTime::minimum() const
+{
+    return m_minimum;
+}
+
+ChatterTime AdaptiveChatterTime::maximum() const
+{
+    return m_maximum;
+}
+
+void AdaptiveChatterTime::reset()
+{
+    KeyHistogram emptyHistogram = {};
+    for (KeyHistogram& histogram : m_keys)
+        histogram = emptyHistogram;
+}
+
+void AdaptiveChatterTime::reset(std::size_t key)
+{
+    KeyHistogram emptyHistogram = {};
+    if (key < m_keys.size())
+        m_keys[key] = emptyHistogram;
+}
+
+bool AdaptiveChatterTime::record(std::size_t key, ChatterTime interval, ChatterTime& chatterTime)
+{
+    if (key >= m_keys.size() || interval < ChatterTime::zero())
+        return false;
+
+    // A time above the maximum is a press of the user, it is not
+    // counted into the buckets but a key never chattering is learned too.
+    KeyHistogram& histogram = m_keys[key];
+    bool isFull = false;
+    if (interval < m_maximum)
+    {
+        std::size_t bucket = static_cast<std::size_t>(interval / m_bucketWidth);
+        if (bucket >= bucketCount)
+            bucket = bucketCount - 1;
+        histogram.counts[bucket]++;
+        isFull = histogram.counts[bucket] == UINT16_MAX;
+    }
+    histogram.sampleCount++;
+
+    // Forget half of the history, a bucket seen once is emptied.
+    // The key stays learned, so its chatter time is still updated.
+    if (histogram.sampleCount % decayPeriod == 0 || isFull)
+    {
+        for (std::size_t i = 0; i < bucketCount; i++)
+            histogram.counts[i] /= 2;
+        histogram.sampleCount = minimumSampleCount;
+    }
+
+    if (histogram.sampleCount < minimumSampleCount || histogram.sampleCount % updatePeriod != 0)
+        return false;
+
+    chatterTime = computeChatterTime(histogram);
+    return true;
+}
+
+ChatterTime AdaptiveChatterTime::computeChatterTime(const KeyHistogram& histogram) const
+{
+    // Find the first group of non empty buckets, starting from zero.
+    std::size_t first = 0;
+    while (first < bucketCount && histogram.counts[first] == 0)
+        first++;
+    if (first == bucketCount)
+        return m_minimum;
+
+    std::size_t last = first;
+    while (last + 1 < bucketCount && histogram.counts[last + 1] != 0)
+        last++;
+
+    // The end of the group, with a margin of one bucket.
+    ChatterTime chatterTime = m_bucketWidth * static_cast<ChatterTime::rep>(last + 2);
+    if (chatterTime < m_minimum)
+        return m_minimum;
+    if (chatterTime > m_maximum)
+        return m_maximum;
+    return chatterTime;
+}
@@ -20,15 +20,35 @@
 #include "KeyPressData.h"
 #include "KeyboardHook.h"
 #include "CommandLineParsing.h"
+#include <algorithm>
 #include <iostream>
 
+namespace
+{
+    // Time after which Windows drops a slow low level hook, set in the registry
+    // of the user. Windows 10 waits 1 second at most, 300 ms is assumed if it is not set.
+    ChatterTime lowLevelHooksTimeout()
+    {
+        DWORD timeout = 0;
+        DWORD size = sizeof(timeout);
+        if (RegGetValueA(HKEY_CURRENT_USER, "Control Panel\\Desktop", "LowLevelHooksTimeout",
+                RRF_RT_REG_DWORD, nullptr, &timeout, &size) != ERROR_SUCCESS || timeout == 0)
+            timeout = 300;
+        return std::chrono::milliseconds(std::min<DWORD>(timeout, 1000));
+    }
+}
+
 std::unique_ptr<Application> Application::_instance = nullptr;
 
 Application::Application(int &argc, char**& argv) :
     m_isApplicationRunning(true),
     m_initSuccess(0),
     m_hookID(0),
-    m_hookThreadID(0)
+    m_hookThreadID(0),
+    m_installedHookID(NULL),
+    m_installedThreadID(0),
+    m_installCount(0),
+    m_isFinished(false)
 {
     init(argc, argv);
 }
@@ -70,18 +90,21 @@ Application* Application::instance()
 
 void Application::deinit()
 {
-    // Send a quit message into the hook thread to ask him to exit.
-    // Then unhook.
-    if (m_hookID != NULL)
+    // Stop the watchdog first, it would install the hook again.
+    // Then send a quit message into the hook thread to ask him to exit,
+    // wait for the threads of the previous hooks and unhook.
+    if (!m_tKeyboardHooks.empty())
+        KeyPressData::instance()->hookWatchdog().stop();
+    if (m_hookThreadID != 0)
+        PostThreadMessage(m_hookThreadID, WM_QUIT, NULL, NULL);
+    for (std::thread& thread : m_tKeyboardHooks)
     {
-        if (m_hookThreadID != 0)
-        {
-            PostThreadMessage(m_hookThreadID, WM_QUIT, NULL, NULL);
-        }
-        if (m_tKeyboardHook.joinable())
-            m_tKeyboardHook.join();
-        UnhookWindowsHookEx(m_hookID);
+        if (thread.joinable())
+            thread.join();
     }
+    m_tKeyboardHooks.clear();
+    if (m_hookID != NULL)
+        UnhookWindowsHookEx(m_hookID);
     m_hookID = NULL;
     m_hookThreadID = NULL;
     m_isApplicationRunning = false;
@@ -90,15 +113,30 @@ void Application::deinit()
 bool Application::run()
 {
     // This is the main loop of the application.
-    // It wait until the application need to close.
+    // It sleeps until the application need to close.
     if (!m_initSuccess)
         return false;
-    
-    while (m_isApplicationRunning)
+
+    {
+        std::unique_lock<std::mutex> lock(m_stateMutex);
+        m_stateCondition.wait(lock, [this]() { return !m_isApplicationRunning; });
+    }
+
+    // Free the resources from the main thread, the Ctrl+C handler
+    // is waiting for it before letting the system close the program.
+    deinit();
+    KeyPressData::instance()->waitForThreadToFinish();
+
+    // Print the time spent in the keyboard hook and its incidents before exiting.
+    KeyPressData::instance()->hookLatency().print(std::cout);
+    KeyPressData::instance()->hookWatchdog().print(std::cout);
+    KeyPressData::instance()->recorder().print(std::cout);
+
     {
-        KeyPressData::instance()->removingFinishedThread();
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        std::lock_guard<std::mutex> guard(m_stateMutex);
+        m_isFinished = true;
     }
+    m_stateCondition.notify_all();
     
     return true;
 }
@@ -119,6 +157,59 @@ void Application::init(int& argc, char**& argv)
     if (cmdParsing.isMSecSet())
         KeyPressData::instance()->setChatterTime(cmdParsing.msec());
 
+    // Read the chatter times of each key, the time of chatter is the default one.
+    // The file is read again each time it is written.
+    if (cmdParsing.isConfigSet())
+    {
+        std::string error;
+        if (!KeyPressData::instance()->loadConfig(cmdParsing.configPath(), error))
+        {
+            std::cerr << "-c, --config, " << error << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    // Keep the live statistics into a file.
+    if (cmdParsing.isStatisticsSet())
+    {
+        std::string error;
+        if (!KeyPressData::instance()->openStatistics(cmdParsing.statisticsPath(), error))
+        {
+            std::cerr << "-s, --stats, " << error << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    // Record the key events and the decisions.
+    if (cmdParsing.isRecordSet())
+    {
+        std::string error;
+        if (!KeyPressData::instance()->startRecording(cmdParsing.recordPath(), error))
+        {
+            std::cerr << "--record, " << error << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    // Answer the requests of KeyChatteringControl.
+    if (cmdParsing.isControlSet())
+    {
+        std::string error;
+        if (!KeyPressData::instance()->startControl(cmdParsing.controlName(), error))
+        {
+            std::cerr << "--control, " << error << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    // Learn the time of chatter of each key if asked.
+    if (cmdParsing.isAdaptiveSet() &&
+        !KeyPressData::instance()->enableAdaptiveChatterTime(cmdParsing.adaptiveMinimum(), cmdParsing.adaptiveMaximum()))
+    {
+        std::cerr << "-a, --adaptive, the chatter policy of this build never learns the chatter times." << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
     // Enable debug.
     bool debug = false;
     if (cmdParsing.isDebugSet())
@@ -129,57 +220,128 @@ void Application::init(int& argc, char**& argv)
 
     std::cout << "Program starting!" << std::endl;
 
-    // Create the hook into an another thread.
-    m_tKeyboardHook = std::thread(&Application::initAndRunKeyboardHook, this);
+    // Create the hook into an another thread, and wait until it has been initialized.
+    m_initSuccess = installKeyboardHook() ? 1 : -1;
 
     // Create the Ctrl+C signal handler.
     createCtrlCSignalHandler();
 
-    // Wait until the hook has been initialized.
-    while (m_initSuccess == 0)
-    {
-        std::this_thread::sleep_for(std::chrono::nanoseconds(500));
-    }
-
     if (m_initSuccess < 0)
     {
         m_isApplicationRunning = false;
         std::cout << "Failed to create the keyboard hook." << std::endl;
     }
+    else
+    {
+        // Install the hook again if Windows drops it.
+        HookWatchdogSettings settings = { lowLevelHooksTimeout() };
+        KeyPressData::instance()->hookWatchdog().start(*this, settings);
+    }
 
     std::cout << "init success!" << std::endl;
 }
 
-void Application::initAndRunKeyboardHook()
+bool Application::installKeyboardHook()
+{
+    // Start a new hook thread and wait until its hook is installed.
+    // The new hook replaces the previous one, which is removed,
+    // and the previous thread is asked to exit.
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    const unsigned int installCount = m_installCount;
+    m_tKeyboardHooks.push_back(std::thread(&Application::runKeyboardHook, this));
+    m_stateCondition.wait(lock, [&]() { return m_installCount != installCount; });
+    if (m_installedHookID == NULL)
+        return false;
+
+    const HHOOK previousHookID = m_hookID.exchange(m_installedHookID);
+    const DWORD previousThreadID = m_hookThreadID.exchange(m_installedThreadID);
+    if (previousHookID != NULL)
+        UnhookWindowsHookEx(previousHookID);
+    if (previousThreadID != 0)
+        PostThreadMessage(previousThreadID, WM_QUIT, NULL, NULL);
+    return true;
+}
+
+void Application::runKeyboardHook()
 {
     // This function initialize the hook
     // and the loop is used to get the signal
     // of the key pressed and released.
 
     // Getting the threadid, it is used to send the quit signal.
-    m_hookThreadID = GetCurrentThreadId();
+    // The message queue of the thread is created first, so the quit
+    // signal is never lost.
+    MSG msg;
+    PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+    const DWORD threadID = GetCurrentThreadId();
 
     // Create the hook.
-    m_hookID = SetWindowsHookEx(
+    const HHOOK hookID = SetWindowsHookEx(
         WH_KEYBOARD_LL,
         keyHookProc,
         nullptr,
         NULL);
 
-    if (m_hookID == 0)
-        m_initSuccess = -1;
-    else
-        m_initSuccess = 1;
+    // Wake up the thread waiting for the hook.
+    {
+        std::lock_guard<std::mutex> guard(m_stateMutex);
+        m_installedHookID = hookID;
+        m_installedThreadID = threadID;
+        m_installCount++;
+    }
+    m_stateCondition.notify_all();
+    if (hookID == NULL)
+        return;
 
     // Get the signals of the input pressed and released.
     // It will also get the quit signal.
-    MSG msg;
     while (GetMessage(&msg, NULL, NULL, NULL) > 0)
     {
         TranslateMessage(&msg);
         DispatchMessage(&msg);
     }
-    m_isApplicationRunning = false;
+
+    // The thread of a hook replaced by the watchdog exits silently.
+    if (m_hookThreadID == threadID)
+        quit();
+}
+
+bool Application::reinstall()
+{
+    // Called by the watchdog, after the initialization
+    // and before the hook is removed by deinit.
+    return installKeyboardHook();
+}
+
+void Application::probe()
+{
+    // Called by the watchdog, the hook answers and discards the probe.
+    INPUT input;
+    ZeroMemory(&input, sizeof(INPUT));
+    input.type = INPUT_KEYBOARD;
+    input.ki.wVk = hookProbeKey;
+    input.ki.dwFlags = KEYEVENTF_KEYUP;
+    input.ki.dwExtraInfo = hookProbeTag;
+    SendInput(1, &input, sizeof(INPUT));
+}
+
+void Application::quit()
+{
+    // Wake up the main thread, it frees the resources.
+    {
+        std::lock_guard<std::mutex> guard(m_stateMutex);
+        m_isApplicationRunning = false;
+    }
+    m_stateCondition.notify_all();
+}
+
+void Application::quitAndWait()
+{
+    // The program is closed by the system when the Ctrl+C handler
+    // returns, so wait until the main thread has freed the resources.
+    quit();
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    m_stateCondition.wait(lock, [this]() { return m_isFinished; });
 }
 
 void Application::createCtrlCSignalHandler()
@@ -195,14 +357,20 @@ BOOL Application::ctrlcSignalHandler(DWORD signal)
     // the resources and exit.
     switch (signal)
     {
+    case CTRL_BREAK_EVENT:
+    {
+        // Ctrl+Break print the time spent in the keyboard hook
+        // without closing the program.
+        KeyPressData::instance()->hookLatency().print(std::cout);
+        KeyPressData::instance()->hookWatchdog().print(std::cout);
+    } break;
+
     case CTRL_C_EVENT:
     case CTRL_CLOSE_EVENT:
     case CTRL_LOGOFF_EVENT:
     case CTRL_SHUTDOWN_EVENT:
-    case CTRL_BREAK_EVENT:
     {
-        instance()->deinit();
-        KeyPressData::instance()->waitForThreadToFinish();
+        instance()->quitAndWait();
     } break;
     }
 
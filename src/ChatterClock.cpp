@@ -0,0 +1,67 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ChatterClock.h"
+#include <cmath>
+
+ChatterTime chatterTimeFromMilliseconds(double msec)
+{
+    return ChatterTime(std::llround(msec * 1000.));
+}
+
+double chatterTimeToMilliseconds(ChatterTime time)
+{
+    return time.count() / 1000.;
+}
+
+bool isValidChatterTime(double msec)
+{
+    // Written so that NaN fails both comparisons.
+    return msec >= 0.001 && msec <= maxChatterTimeMilliseconds;
+}
+
+ChatterClock::~ChatterClock()
+{}
+
+SteadyChatterClock::SteadyChatterClock() :
+    m_startTime(std::chrono::steady_clock::now())
+{}
+
+ChatterTime SteadyChatterClock::now() const
+{
+    return toChatterTime(std::chrono::steady_clock::now());
+}
+
+ChatterTime SteadyChatterClock::toChatterTime(std::chrono::steady_clock::time_point timePoint) const
+{
+    return std::chrono::duration_cast<ChatterTime>(timePoint - m_startTime);
+}
+
+ManualChatterClock::ManualChatterClock() :
+    m_time(0)
+{}
+
+ChatterTime ManualChatterClock::now() const
+{
+    return m_time;
+}
+
+void ManualChatterClock::setTime(ChatterTime time)
+{
+    m_time = time;
+}
@@ -0,0 +1,242 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "ChatterConfig.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+    // Split a line into words, a word between double quotes can contain spaces.
+    bool splitLine(const std::string& line, std::vector<std::string>& words)
+    {
+        words.clear();
+        std::size_t i = 0;
+        while (i < line.size())
+        {
+            const char c = line[i];
+            if (c == ' ' || c == '\t' || c == '\r')
+            {
+                i++;
+                continue;
+            }
+            if (c == '#')
+                break;
+
+            if (c == '"')
+            {
+                const std::size_t end = line.find('"', i + 1);
+                if (end == std::string::npos)
+                    return false;
+                words.push_back(line.substr(i + 1, end - i - 1));
+                i = end + 1;
+            }
+            else
+            {
+                const std::size_t end = line.find_first_of(" \t\r#", i);
+                words.push_back(line.substr(i, end == std::string::npos ? std::string::npos : end - i));
+                i = end == std::string::npos ? line.size() : end;
+            }
+        }
+        return true;
+    }
+
+    bool parseTime(const char* text, ChatterTime& time)
+    {
+        char* end = nullptr;
+        const double msec = std::strtod(text, &end);
+        if (end == text || *end != '\0' || !isValidChatterTime(msec))
+            return false;
+        time = chatterTimeFromMilliseconds(msec);
+        return true;
+    }
+}
+
+ChatterConfig::ChatterConfig() :
+    m_defaultSetting(),
+    m_categorySettings(),
+    m_keySettings()
+{
+    m_defaultSetting.hasEnabled = true;
+    m_defaultSetting.isEnabled = true;
+    setDefaultChatterTime(std::chrono::milliseconds(50));
+}
+
+void ChatterConfig::setDefaultChatterTime(ChatterTime time)
+{
+    // Only the times change, a default line turning the keys off is kept.
+    m_defaultSetting.hasPress = true;
+    m_defaultSetting.hasRelease = true;
+    m_defaultSetting.press = time;
+    m_defaultSetting.release = time;
+    compile();
+}
+
+ChatterTime ChatterConfig::defaultChatterTime() const
+{
+    return m_defaultSetting.press;
+}
+
+bool ChatterConfig::readFile(const std::string& path, std::string& error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "cannot open " + path + ".";
+        return false;
+    }
+    if (!read(file, error))
+    {
+        error = "invalid configuration, " + error;
+        return false;
+    }
+    return true;
+}
+
+bool ChatterConfig::read(std::istream& stream, std::string& error)
+{
+    std::string line;
+    std::vector<std::string> words;
+    std::size_t lineNumber = 0;
+
+    while (std::getline(stream, line))
+    {
+        lineNumber++;
+        const std::string location = "line " + std::to_string(lineNumber) + ": ";
+
+        if (!splitLine(line, words))
+        {
+            error = location + "missing closing double quote.";
+            return false;
+        }
+        if (words.empty())
+            continue;
+
+        // Find the setting changed by the line.
+        Setting* setting = nullptr;
+        std::size_t first = 1;
+        if (words[0] == "default")
+            setting = &m_defaultSetting;
+        else if (words[0] == "category" || words[0] == "key")
+        {
+            if (words.size() < 2)
+            {
+                error = location + "expected a name after " + words[0] + ".";
+                return false;
+            }
+            first = 2;
+
+            KeyCategory category = KeyCategory::Unknown;
+            unsigned long key = 0;
+            if (words[0] == "category" && keyCategoryFromName(words[1].c_str(), category))
+                setting = &m_categorySettings[static_cast<std::size_t>(category)];
+            else if (words[0] == "key" && keyFromName(words[1].c_str(), key))
+                setting = &m_keySettings[key];
+            else
+            {
+                error = location + "unknown " + words[0] + " \"" + words[1] + "\".";
+                return false;
+            }
+        }
+        else
+        {
+            error = location + "unknown setting \"" + words[0] + "\", expected default, category or key.";
+            return false;
+        }
+
+        for (std::size_t i = first; i < words.size(); i++)
+        {
+            const std::string& word = words[i];
+            const std::size_t equal = word.find('=');
+            const std::string name = word.substr(0, equal);
+            const char* value = equal == std::string::npos ? nullptr : word.c_str() + equal + 1;
+
+            ChatterTime time;
+            if (!value && (name == "on" || name == "off"))
+            {
+                setting->hasEnabled = true;
+                setting->isEnabled = name == "on";
+            }
+            else if (value && (name == "press" || name == "release" || name == "time"))
+            {
+                if (!parseTime(value, time))
+                {
+                    error = location + "invalid time \"" + word + "\", expected a number of milliseconds between 0.001 and 10000.";
+                    return false;
+                }
+                if (name != "release")
+                {
+                    setting->hasPress = true;
+                    setting->press = time;
+                }
+                if (name != "press")
+                {
+                    setting->hasRelease = true;
+                    setting->release = time;
+                }
+            }
+            else
+            {
+                error = location + "invalid option \"" + word + "\", expected press=, release=, time=, on or off.";
+                return false;
+            }
+        }
+    }
+
+    compile();
+    return true;
+}
+
+const KeyChatterTime& ChatterConfig::keyChatterTime(unsigned long key) const
+{
+    if (key >= keyTableSize)
+        return m_keyChatterTimes[0];
+    return m_keyChatterTimes[key];
+}
+
+bool ChatterConfig::isBypassed(unsigned long key) const
+{
+    return key < keyTableSize && m_bypassedKeys[key];
+}
+
+const std::bitset<keyTableSize>& ChatterConfig::bypassedKeys() const
+{
+    return m_bypassedKeys;
+}
+
+void ChatterConfig::compile()
+{
+    // Resolve the settings of each key: the key line first,
+    // then the category line, then the default line.
+    for (std::size_t key = 0; key < keyTableSize; key++)
+    {
+        const Setting& keySetting = m_keySettings[key];
+        const Setting& categorySetting = m_categorySettings[static_cast<std::size_t>(keyCategory(key))];
+
+        KeyChatterTime& time = m_keyChatterTimes[key];
+        time.press = keySetting.hasPress ? keySetting.press :
+            (categorySetting.hasPress ? categorySetting.press : m_defaultSetting.press);
+        time.release = keySetting.hasRelease ? keySetting.release :
+            (categorySetting.hasRelease ? categorySetting.release : m_defaultSetting.release);
+
+        const bool isEnabled = keySetting.hasEnabled ? keySetting.isEnabled :
+            (categorySetting.hasEnabled ? categorySetting.isEnabled : m_defaultSetting.isEnabled);
+        m_bypassedKeys[key] = !isEnabled;
+    }
+}
@@ -0,0 +1,549 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ChatterEngine.h"
+#include <algorithm>
+
+namespace
+{
+    // Resolution of the timer wheel: one millisecond.
+    const std::int64_t wheelResolution = 1000;
+}
+
+template<typename Policy>
+const std::size_t BasicChatterEngine<Policy>::keyCount;
+template<typename Policy>
+const std::size_t BasicChatterEngine<Policy>::defaultDeviceCount;
+
+template<typename Policy>
+BasicChatterEngine<Policy>::BasicChatterEngine(std::size_t deviceCount) :
+    m_deviceKeys(new DeviceKeys[deviceCount > 0 ? deviceCount : 1]),
+    m_devices(deviceCount),
+    m_lastDevice(defaultDevice),
+    m_lastTable(0),
+    m_settings(ChatterSettings()),
+    m_pendingReleases(keyCount * m_devices.tableCount(), wheelResolution),
+    m_adaptiveChatterTime(Policy::learning == ChatterLearning::Never ? 0 : keyCount * m_devices.tableCount()),
+    m_isAdaptive(Policy::learning == ChatterLearning::Always),
+    m_statistics(nullptr)
+{
+    setChatterTime(std::chrono::milliseconds(50));
+}
+
+template<typename Policy>
+ChatterResult BasicChatterEngine<Policy>::processKeyEvent(unsigned long key, bool isPressed, ChatterTime time)
+{
+    if (isPressed)
+        return pressKey(0, key, time);
+    else
+        return releaseKey(0, key, time);
+}
+
+template<typename Policy>
+ChatterResult BasicChatterEngine<Policy>::processKeyPress(unsigned long key, ChatterTime time)
+{
+    return pressKey(0, key, time);
+}
+
+template<typename Policy>
+ChatterResult BasicChatterEngine<Policy>::processKeyRelease(unsigned long key, ChatterTime time)
+{
+    return releaseKey(0, key, time);
+}
+
+template<typename Policy>
+ChatterResult BasicChatterEngine<Policy>::processKeyEvent(DeviceId device, unsigned long key, bool isPressed, ChatterTime time)
+{
+    if (isPressed)
+        return pressKey(tableOfDevice(device), key, time);
+    else
+        return releaseKey(tableOfDevice(device), key, time);
+}
+
+template<typename Policy>
+ChatterResult BasicChatterEngine<Policy>::processKeyPress(DeviceId device, unsigned long key, ChatterTime time)
+{
+    return pressKey(tableOfDevice(device), key, time);
+}
+
+template<typename Policy>
+ChatterResult BasicChatterEngine<Policy>::processKeyRelease(DeviceId device, unsigned long key, ChatterTime time)
+{
+    return releaseKey(tableOfDevice(device), key, time);
+}
+
+template<typename Policy>
+bool BasicChatterEngine<Policy>::removeDevice(DeviceId device)
+{
+    // The table is cleared when it is given to the next device.
+    const std::size_t table = m_devices.find(device);
+    if (table == DeviceTable::noTable || !m_devices.release(device))
+        return false;
+
+    for (std::size_t key = 0; key < keyCount; key++)
+    {
+        KeyInfo& keyInfo = m_deviceKeys[table].keyInfo[key];
+        if (keyInfo.isReleasePending)
+            cancelRelease(table, key, keyInfo);
+    }
+    if (m_lastDevice == device)
+    {
+        m_lastDevice = defaultDevice;
+        m_lastTable = 0;
+    }
+    return true;
+}
+
+template<typename Policy>
+std::size_t BasicChatterEngine<Policy>::deviceCount() const
+{
+    return m_devices.usedCount();
+}
+
+template<typename Policy>
+std::size_t BasicChatterEngine<Policy>::maxDeviceCount() const
+{
+    return m_devices.tableCount();
+}
+
+template<typename Policy>
+std::size_t BasicChatterEngine<Policy>::tableOfDevice(DeviceId device)
+{
+    // The events mostly come from the device of the previous event.
+    if (device == m_lastDevice)
+        return m_lastTable;
+
+    // Without a free table, share the table of the default device
+    // until a table is given back.
+    bool isNew = false;
+    const std::size_t table = m_devices.acquire(device, isNew);
+    if (table == DeviceTable::noTable)
+        return 0;
+
+    if (isNew)
+    {
+        for (std::size_t key = 0; key < keyCount; key++)
+            resetKeyInfo(table, key);
+    }
+
+    m_lastDevice = device;
+    m_lastTable = table;
+    return table;
+}
+
+template<typename Policy>
+ChatterResult BasicChatterEngine<Policy>::pressKey(std::size_t table, unsigned long key, ChatterTime time)
+{
+    /*
+    * Check if the key has already been pressed. If yes,
+    * check if the time passed since the last press is lower
+    * than the chatter time of the key. If yes, and if the
+    * press rule of the policy says so, it's mean the key
+    * is a chatter and need to be rejected.
+    */
+    ChatterResult result = {};
+    result.decision = ChatterDecision::Pass;
+
+    if (key >= keyCount)
+    {
+        if (m_statistics != nullptr)
+            m_statistics->unknownKeyEvents.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    count(key, ChatterCounter::PressesSeen);
+    const SettingsSection settings(m_settings);
+    if (settings->bypassedKeys[key])
+        return result;
+
+    KeyInfo& keyInfo = keyInfoOf(table, key, settings);
+
+    // A press after a delayed release shows the release was a chatter,
+    // it is cancelled now instead of being dropped when it is due.
+    if (Policy::defersReleases && keyInfo.isReleasePending && time >= keyInfo.timeWhenReleased)
+        cancelRelease(table, key, keyInfo);
+
+    // If the key has never been pressed, store the time of the press.
+    if (!keyInfo.isAlreadyPressed)
+    {
+        keyInfo.isAlreadyPressed = true;
+        keyInfo.timeWhenPressed = time;
+        keyInfo.timeWhenLastPressed = time;
+        PressRule::startWindow(keyInfo.pressState);
+        return result;
+    }
+
+    result.timeSinceLastPress = time - keyInfo.timeWhenPressed;
+
+    // A press after a release, chattering or not, teaches the chatter time of the key.
+    ChatterTime learnedTime;
+    if (isLearning() && keyInfo.timeWhenLastPressed <= keyInfo.timeWhenReleased &&
+        m_adaptiveChatterTime.record(table * keyCount + key, result.timeSinceLastPress, learnedTime))
+    {
+        keyInfo.timeOfChatter.press = learnedTime;
+        keyInfo.timeOfChatter.release = learnedTime;
+    }
+
+    // The press starts a new window.
+    if (!PressRule::isFiltering || result.timeSinceLastPress >= keyInfo.timeOfChatter.press)
+    {
+        keyInfo.timeWhenPressed = time;
+        keyInfo.timeWhenLastPressed = time;
+        PressRule::startWindow(keyInfo.pressState);
+        return result;
+    }
+
+    // check if the key is a repeat key, if true, accept the key.
+    if (keyInfo.timeWhenLastPressed > keyInfo.timeWhenReleased)
+        return result;
+
+    // A press the rule does not count as a chatter is a new press of the user.
+    if (!PressRule::isChatter(keyInfo.pressState))
+    {
+        keyInfo.timeWhenPressed = time;
+        keyInfo.timeWhenLastPressed = time;
+        PressRule::startWindow(keyInfo.pressState);
+        return result;
+    }
+
+    keyInfo.timeWhenLastPressed = time;
+    result.decision = ChatterDecision::Block;
+    count(key, ChatterCounter::PressesBlocked);
+    return result;
+}
+
+template<typename Policy>
+ChatterResult BasicChatterEngine<Policy>::releaseKey(std::size_t table, unsigned long key, ChatterTime time)
+{
+    /*
+    * Check if the time passed since the last press of the key
+    * is lower than the chatter time of the key. If yes,
+    * it's mean the release may be a chatter and need to be delayed.
+    */
+    ChatterResult result = {};
+    result.decision = ChatterDecision::Pass;
+
+    if (key >= keyCount)
+    {
+        if (m_statistics != nullptr)
+            m_statistics->unknownKeyEvents.fetch_add(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    const SettingsSection settings(m_settings);
+    if (settings->bypassedKeys[key])
+        return result;
+
+    KeyInfo& keyInfo = keyInfoOf(table, key, settings);
+    keyInfo.timeWhenReleased = time;
+    result.timeSinceLastPress = time - keyInfo.timeWhenLastPressed;
+    if (!Policy::defersReleases)
+        return result;
+
+    // If the release of the key happen in a time since le press of the key less than its chatter time,
+    // then, delaying the key release. A previous delayed release of the same key is replaced.
+    if (result.timeSinceLastPress < keyInfo.timeOfChatter.release)
+    {
+        result.decision = ChatterDecision::Delay;
+        result.releaseTime = time + keyInfo.timeOfChatter.release;
+        if (keyInfo.isReleasePending)
+            count(key, ChatterCounter::ReleasesCancelled);
+        m_pendingReleases.schedule(table * keyCount + key, result.releaseTime.count());
+        keyInfo.isReleasePending = true;
+        count(key, ChatterCounter::ReleasesDeferred);
+    }
+    else if (keyInfo.isReleasePending)
+    {
+        // This release is kept, a previous delayed release of the key is no more needed.
+        cancelRelease(table, key, keyInfo);
+    }
+
+    return result;
+}
+
+template<typename Policy>
+std::size_t BasicChatterEngine<Policy>::releaseDueKeys(ChatterTime now, ReleaseSink& sink)
+{
+    /*
+    * Send to the sink the delayed releases whose time is elapsed.
+    * The reason is because of the chatter itself, when a key is chattering,
+    * the key is release but never repressed, so the user is pressing it but in the OS
+    * side, it's like the key is not pressed at all.
+    * A newer release of the key replace or cancel the delayed release, and
+    * a newer press cancels it, so the due releases are real releases.
+    * The presses are still checked here, for the events out of order.
+    * The slots of the wheel are the keys of the first table, then
+    * the keys of the second table...
+    */
+    const std::size_t noSlot = static_cast<std::size_t>(-1);
+    std::size_t dueSlots[keyCount];
+    unsigned long releasedKeys[keyCount];
+    std::size_t releasedCount = 0;
+    std::size_t dueCount = 0;
+
+    do
+    {
+        dueCount = m_pendingReleases.popDue(now.count(), dueSlots, keyCount);
+
+        // The keys of a device due together are released together.
+        for (std::size_t first = 0; first < dueCount; first++)
+        {
+            if (dueSlots[first] == noSlot)
+                continue;
+
+            const std::size_t table = dueSlots[first] / keyCount;
+            std::size_t keyCountOfDevice = 0;
+            for (std::size_t i = first; i < dueCount; i++)
+            {
+                if (dueSlots[i] == noSlot || dueSlots[i] / keyCount != table)
+                    continue;
+
+                // If the time since the last release is higher than the last press, it's mean that the user has released the key,
+                // so we releasing the key.
+                const std::size_t key = dueSlots[i] % keyCount;
+                KeyInfo& keyInfo = m_deviceKeys[table].keyInfo[key];
+                keyInfo.isReleasePending = false;
+                if (keyInfo.timeWhenReleased > keyInfo.timeWhenLastPressed)
+                {
+                    releasedKeys[keyCountOfDevice++] = static_cast<unsigned long>(key);
+                    count(key, ChatterCounter::ReleasesInjected);
+                }
+                else
+                    count(key, ChatterCounter::ReleasesCancelled);
+                dueSlots[i] = noSlot;
+            }
+
+            if (keyCountOfDevice > 0)
+            {
+                sink.releaseDeviceKeys(m_devices.device(table), releasedKeys, keyCountOfDevice);
+                if (m_statistics != nullptr)
+                    m_statistics->releaseBatches.fetch_add(1, std::memory_order_relaxed);
+            }
+            releasedCount += keyCountOfDevice;
+        }
+    } while (dueCount == keyCount);
+
+    return releasedCount;
+}
+
+template<typename Policy>
+bool BasicChatterEngine<Policy>::nextReleaseTime(ChatterTime& time) const
+{
+    std::int64_t deadline = 0;
+    if (!m_pendingReleases.nextDeadline(deadline))
+        return false;
+
+    time = ChatterTime(deadline);
+    return true;
+}
+
+template<typename Policy>
+bool BasicChatterEngine<Policy>::isReleasePending(DeviceId device, unsigned long key, std::size_t& slot) const
+{
+    if (key >= keyCount)
+        return false;
+
+    // The devices without table share the table of the default device.
+    std::size_t table = device == m_lastDevice ? m_lastTable : m_devices.find(device);
+    if (table == DeviceTable::noTable)
+        table = 0;
+    slot = table * keyCount + key;
+    return m_deviceKeys[table].keyInfo[key].isReleasePending;
+}
+
+template<typename Policy>
+void BasicChatterEngine<Policy>::setChatterTime(ChatterTime time)
+{
+    // The new default time of the configuration, for the presses and the
+    // releases. The keys and categories with their own times keep them.
+    if (time <= ChatterTime::zero())
+        return;
+    m_settings.update([this, time](ChatterSettings& settings)
+    {
+        m_config.setDefaultChatterTime(time);
+        compileConfig(settings);
+    });
+}
+
+template<typename Policy>
+ChatterTime BasicChatterEngine<Policy>::chatterTime() const
+{
+    return m_settings.value().chatterTime;
+}
+
+template<typename Policy>
+void BasicChatterEngine<Policy>::setConfig(const ChatterConfig& config)
+{
+    // The configuration is kept, so a new chatter time only changes its default.
+    m_settings.update([this, &config](ChatterSettings& settings)
+    {
+        m_config = config;
+        compileConfig(settings);
+    });
+}
+
+template<typename Policy>
+KeyChatterTime BasicChatterEngine<Policy>::keyChatterTime(unsigned long key) const
+{
+    const SettingsSection settings(m_settings);
+    if (key >= keyCount)
+    {
+        KeyChatterTime time = { settings->chatterTime, settings->chatterTime };
+        return time;
+    }
+
+    const KeyInfo& keyInfo = m_deviceKeys[0].keyInfo[key];
+    if (keyInfo.settingsGeneration != settings.generation())
+        return configuredChatterTime(key, *settings);
+    return keyInfo.timeOfChatter;
+}
+
+template<typename Policy>
+bool BasicChatterEngine<Policy>::isKeyBypassed(unsigned long key) const
+{
+    const SettingsSection settings(m_settings);
+    return key < keyCount && settings->bypassedKeys[key];
+}
+
+template<typename Policy>
+bool BasicChatterEngine<Policy>::enableAdaptiveChatterTime(ChatterTime minimum, ChatterTime maximum)
+{
+    if (Policy::learning == ChatterLearning::Never)
+        return false;
+    m_adaptiveChatterTime.setBounds(minimum, maximum);
+    m_isAdaptive = true;
+    resetKeyChatterTimes();
+    return true;
+}
+
+template<typename Policy>
+void BasicChatterEngine<Policy>::disableAdaptiveChatterTime()
+{
+    // Only a policy learning on request can stop.
+    if (Policy::learning != ChatterLearning::OnRequest)
+        return;
+    m_isAdaptive = false;
+    resetKeyChatterTimes();
+}
+
+template<typename Policy>
+bool BasicChatterEngine<Policy>::isAdaptiveChatterTimeEnabled() const
+{
+    return isLearning();
+}
+
+template<typename Policy>
+bool BasicChatterEngine<Policy>::isLearning() const
+{
+    // Known at compile time, except for a policy learning on request.
+    return Policy::learning == ChatterLearning::Always ||
+        (Policy::learning == ChatterLearning::OnRequest && m_isAdaptive);
+}
+
+template<typename Policy>
+void BasicChatterEngine<Policy>::setStatistics(ChatterStatistics* statistics)
+{
+    m_statistics = statistics;
+}
+
+template<typename Policy>
+void BasicChatterEngine<Policy>::count(std::size_t key, ChatterCounter counter)
+{
+    if (m_statistics != nullptr)
+        m_statistics->increment(key, counter);
+}
+
+template<typename Policy>
+typename BasicChatterEngine<Policy>::KeyInfo& BasicChatterEngine<Policy>::keyInfoOf(std::size_t table, std::size_t key, const SettingsSection& settings)
+{
+    // A key whose settings have been replaced since its last event takes
+    // back its configured chatter times and learns them again.
+    KeyInfo& keyInfo = m_deviceKeys[table].keyInfo[key];
+    if (keyInfo.settingsGeneration != settings.generation())
+    {
+        keyInfo.timeOfChatter = configuredChatterTime(key, *settings);
+        keyInfo.settingsGeneration = settings.generation();
+        if (Policy::learning != ChatterLearning::Never)
+            m_adaptiveChatterTime.reset(table * keyCount + key);
+    }
+    return keyInfo;
+}
+
+template<typename Policy>
+void BasicChatterEngine<Policy>::cancelRelease(std::size_t table, std::size_t key, KeyInfo& keyInfo)
+{
+    // The key knows its slot in the wheel, unlinking it is O(1).
+    m_pendingReleases.cancel(table * keyCount + key);
+    keyInfo.isReleasePending = false;
+    count(key, ChatterCounter::ReleasesCancelled);
+}
+
+template<typename Policy>
+void BasicChatterEngine<Policy>::compileConfig(ChatterSettings& settings) const
+{
+    // Copy the table compiled by the configuration, the hook
+    // then finds the chatter times of a key with its other data.
+    settings.chatterTime = m_config.defaultChatterTime();
+    for (std::size_t i = 0; i < keyCount; i++)
+        settings.keyTimes[i] = m_config.keyChatterTime(static_cast<unsigned long>(i));
+    settings.bypassedKeys = m_config.bypassedKeys();
+}
+
+template<typename Policy>
+void BasicChatterEngine<Policy>::resetKeyChatterTimes()
+{
+    // Give back to each key its configured chatter times. With the adaptive
+    // chatter time, they are kept between the bounds until the key is learned.
+    // Publishing the same settings again is enough, see keyInfoOf.
+    m_settings.update([](ChatterSettings&) {});
+}
+
+template<typename Policy>
+KeyChatterTime BasicChatterEngine<Policy>::configuredChatterTime(std::size_t key, const ChatterSettings& settings) const
+{
+    KeyChatterTime time = settings.keyTimes[key];
+    if (isLearning())
+    {
+        time.press = std::max(m_adaptiveChatterTime.minimum(), std::min(time.press, m_adaptiveChatterTime.maximum()));
+        time.release = std::max(m_adaptiveChatterTime.minimum(), std::min(time.release, m_adaptiveChatterTime.maximum()));
+    }
+    return time;
+}
+
+template<typename Policy>
+void BasicChatterEngine<Policy>::resetKeyInfo(std::size_t table, std::size_t key)
+{
+    // A new device starts with the configured chatter times and nothing learned,
+    // given by keyInfoOf at the first event of the key.
+    KeyInfo& keyInfo = m_deviceKeys[table].keyInfo[key];
+    keyInfo.timeWhenPressed = ChatterTime::zero();
+    keyInfo.timeWhenLastPressed = ChatterTime::zero();
+    keyInfo.timeWhenReleased = ChatterTime::zero();
+    keyInfo.settingsGeneration = 0;
+    keyInfo.pressState = typename PressRule::KeyState();
+    keyInfo.isAlreadyPressed = false;
+    keyInfo.isReleasePending = false;
+}
+
+// The policies compiled into the library, a policy is added here and in ChatterEngine.h.
+template class BasicChatterEngine<DefaultChatterPolicy>;
+template class BasicChatterEngine<FixedWindowPolicy>;
+template class BasicChatterEngine<PressOnlyPolicy>;
+template class BasicChatterEngine<ReleaseDeferPolicy>;
+template class BasicChatterEngine<CountInWindowPolicy<2> >;
+template class BasicChatterEngine<AdaptivePolicy>;
@@ -0,0 +1,79 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ChatterReplay.h"
+
+ChatterReplay::ChatterReplay(ChatterEngine& engine) :
+    m_engine(engine),
+    m_eventIndex(0),
+    m_eventCount(0)
+{}
+
+ChatterReplay::~ChatterReplay()
+{}
+
+void ChatterReplay::replay(const KeyEvent* events, std::size_t count)
+{
+    m_eventCount = 0;
+    for (std::size_t i = 0; i < count; i++)
+        replay(events[i]);
+
+    // Send the releases still delayed at the end of the trace.
+    releaseKeysUntil(ChatterTime::max());
+}
+
+void ChatterReplay::replay(const std::vector<KeyEvent>& events)
+{
+    replay(events.data(), events.size());
+}
+
+void ChatterReplay::replay(const KeyEvent& event)
+{
+    releaseKeysUntil(event.time);
+
+    m_clock.setTime(event.time);
+    m_eventIndex = m_eventCount++;
+    onKeyEvent(event, m_engine.processKeyEvent(event.device, event.key, event.isPressed, event.time));
+}
+
+std::size_t ChatterReplay::eventIndex() const
+{
+    return m_eventIndex;
+}
+
+void ChatterReplay::releaseKey(unsigned long key)
+{
+    onKeyRelease(m_clock.now(), defaultDevice, key);
+}
+
+void ChatterReplay::releaseDeviceKeys(DeviceId device, const unsigned long* keys, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+        onKeyRelease(m_clock.now(), device, keys[i]);
+}
+
+void ChatterReplay::releaseKeysUntil(ChatterTime time)
+{
+    // Move the virtual clock to each delayed release due before time.
+    ChatterTime releaseTime;
+    while (m_engine.nextReleaseTime(releaseTime) && releaseTime <= time)
+    {
+        m_clock.setTime(releaseTime);
+        m_engine.releaseDueKeys(releaseTime, *this);
+    }
+}
@@ -17,12 +17,22 @@
 */
 
 #include "CommandLineParsing.h"
+#include "ChatterClock.h"
+#include <cstdlib>
 #include <iostream>
+#include <string>
 
 CommandLineParsing::CommandLineParsing(int& argc, char**& argv) :
-    m_msec(0),
     m_msecSet(false),
-    m_debugSet(false)
+    m_msec(0.),
+    m_debugSet(false),
+    m_adaptiveSet(false),
+    m_adaptiveMinimum(0.),
+    m_adaptiveMaximum(0.),
+    m_configSet(false),
+    m_statisticsSet(false),
+    m_controlSet(false),
+    m_recordSet(false)
 {
     if (argc <= 0 || argv == nullptr)
         return;
@@ -32,7 +42,12 @@ CommandLineParsing::CommandLineParsing(int& argc, char**& argv) :
 
     // Adding the command line options.
     options.add_options()
-        ("t,time", "Time since last press of the same key to treat this key has a chatter", cxxopts::value<int>())
+        ("t,time", "Time since last press of the same key to treat this key has a chatter, in milliseconds (fractions like 0.5 are allowed)", cxxopts::value<double>())
+        ("a,adaptive", "Learn the time of chatter of each key, between min and max milliseconds", cxxopts::value<std::string>(), "min,max")
+        ("c,config", "Read the chatter times of each key from a configuration file", cxxopts::value<std::string>(), "file")
+        ("s,stats", "Keep live statistics into a memory mapped file, read by KeyChatteringStats", cxxopts::value<std::string>(), "file")
+        ("control", "Answer the requests of KeyChatteringControl on the named pipe \\\\.\\pipe\\<name>", cxxopts::value<std::string>(), "name")
+        ("record", "Record every key event and the decision taken into a binary file, read by KeyChatteringReplay", cxxopts::value<std::string>(), "file")
         ("d,debug", "Print debug information when a key is chattering")
         ("v,version", "Show the version of the program")
         ("h,help", "Print usage information.");
@@ -61,7 +76,7 @@ CommandLineParsing::CommandLineParsing(int& argc, char**& argv) :
     {
         try
         {
-            m_msec = result["time"].as<int>();
+            m_msec = result["time"].as<double>();
             m_msecSet = true;
         }
         catch (const cxxopts::OptionParseException& e)
@@ -73,13 +88,64 @@ CommandLineParsing::CommandLineParsing(int& argc, char**& argv) :
             std::exit(EXIT_FAILURE);
         }
 
-        if (m_msec <= 0)
+        // The chatter engine counts in microseconds.
+        if (!isValidChatterTime(m_msec))
         {
-            std::cerr << "-t, --time, invalid argument. The argument must be a positive number." << std::endl;
+            std::cerr << "-t, --time, invalid argument. The argument must be between 0.001 (one microsecond) and 10000." << std::endl;
             std::exit(EXIT_FAILURE);
         }
     }
 
+    // Retrieve the bounds of the adaptive time of chatter.
+    if (result.count("adaptive"))
+    {
+        const std::string value = result["adaptive"].as<std::string>();
+        char* end = nullptr;
+        m_adaptiveMinimum = std::strtod(value.c_str(), &end);
+        bool isValid = end != value.c_str() && *end == ',' && m_adaptiveMinimum >= 0.;
+        if (isValid)
+        {
+            const char* maximum = end + 1;
+            m_adaptiveMaximum = std::strtod(maximum, &end);
+            isValid = end != maximum && *end == '\0' && isValidChatterTime(m_adaptiveMaximum) && m_adaptiveMinimum <= m_adaptiveMaximum;
+        }
+
+        if (!isValid)
+        {
+            std::cerr << "-a, --adaptive, invalid argument. The argument must be <min>,<max> in milliseconds, at most 10000." << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        m_adaptiveSet = true;
+    }
+
+    // Retrieve the configuration file.
+    if (result.count("config"))
+    {
+        m_configPath = result["config"].as<std::string>();
+        m_configSet = true;
+    }
+
+    // Retrieve the statistics file.
+    if (result.count("stats"))
+    {
+        m_statisticsPath = result["stats"].as<std::string>();
+        m_statisticsSet = true;
+    }
+
+    // Retrieve the name of the control pipe.
+    if (result.count("control"))
+    {
+        m_controlName = result["control"].as<std::string>();
+        m_controlSet = true;
+    }
+
+    // Retrieve the recording file.
+    if (result.count("record"))
+    {
+        m_recordPath = result["record"].as<std::string>();
+        m_recordSet = true;
+    }
+
     // Check if debug is set.
     if (result.count("debug"))
         m_debugSet = true;
@@ -90,7 +156,7 @@ bool CommandLineParsing::isMSecSet() const
     return m_msecSet;
 }
 
-int CommandLineParsing::msec() const
+double CommandLineParsing::msec() const
 {
     return m_msec;
 }
@@ -98,4 +164,59 @@ int CommandLineParsing::msec() const
 bool CommandLineParsing::isDebugSet() const
 {
     return m_debugSet;
-}
\ No newline at end of file
+}
+
+bool CommandLineParsing::isAdaptiveSet() const
+{
+    return m_adaptiveSet;
+}
+
+double CommandLineParsing::adaptiveMinimum() const
+{
+    return m_adaptiveMinimum;
+}
+
+double CommandLineParsing::adaptiveMaximum() const
+{
+    return m_adaptiveMaximum;
+}
+
+bool CommandLineParsing::isConfigSet() const
+{
+    return m_configSet;
+}
+
+const std::string& CommandLineParsing::configPath() const
+{
+    return m_configPath;
+}
+
+bool CommandLineParsing::isStatisticsSet() const
+{
+    return m_statisticsSet;
+}
+
+const std::string& CommandLineParsing::statisticsPath() const
+{
+    return m_statisticsPath;
+}
+
+bool CommandLineParsing::isControlSet() const
+{
+    return m_controlSet;
+}
+
+const std::string& CommandLineParsing::controlName() const
+{
+    return m_controlName;
+}
+
+bool CommandLineParsing::isRecordSet() const
+{
+    return m_recordSet;
+}
+
+const std::string& CommandLineParsing::recordPath() const
+{
+    return m_recordPath;
+}
@@ -0,0 +1,253 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ConfigWatcher.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace
+{
+    // Split a path into its directory and its file name.
+    void splitPath(const std::string& path, std::string& directory, std::string& fileName)
+    {
+#ifdef _WIN32
+        const std::size_t slash = path.find_last_of("\\/");
+#else
+        const std::size_t slash = path.rfind('/');
+#endif
+        if (slash == std::string::npos)
+        {
+            directory = ".";
+            fileName = path;
+        }
+        else
+        {
+            directory = slash == 0 ? path.substr(0, 1) : path.substr(0, slash);
+            fileName = path.substr(slash + 1);
+        }
+    }
+}
+
+ConfigWatcher::ConfigWatcher(ControlTarget& target, std::ostream& log) :
+    m_target(target),
+    m_log(log),
+    m_isRunning(false),
+#ifdef _WIN32
+    m_change(INVALID_HANDLE_VALUE),
+    m_stopEvent(nullptr),
+    m_lastWriteTime(0)
+#else
+    m_inotify(-1)
+#endif
+{
+#ifndef _WIN32
+    m_wakeUpPipe[0] = -1;
+    m_wakeUpPipe[1] = -1;
+#endif
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    stop();
+}
+
+bool ConfigWatcher::isRunning() const
+{
+    return m_isRunning;
+}
+
+void ConfigWatcher::reload()
+{
+    std::string error;
+    if (m_target.reloadConfig(error))
+        m_log << "Configuration reloaded." << std::endl;
+    else
+        m_log << "Configuration not reloaded, " << error << std::endl;
+}
+
+#ifdef _WIN32
+
+namespace
+{
+    // Last write time of a file, 0 if it cannot be read.
+    unsigned long long lastWriteTimeOf(const std::string& path)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data))
+            return 0;
+        return (static_cast<unsigned long long>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+            data.ftLastWriteTime.dwLowDateTime;
+    }
+}
+
+bool ConfigWatcher::start(const std::string& path, std::string& error)
+{
+    stop();
+
+    std::string directory;
+    splitPath(path, directory, m_fileName);
+    m_path = path;
+    m_lastWriteTime = lastWriteTimeOf(path);
+
+    m_change = FindFirstChangeNotificationA(directory.c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    m_stopEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    if (m_change == INVALID_HANDLE_VALUE || m_stopEvent == nullptr)
+    {
+        error = "cannot watch " + directory + " (error " + std::to_string(GetLastError()) + ").";
+        stop();
+        return false;
+    }
+
+    m_isRunning = true;
+    m_thread = std::thread(&ConfigWatcher::run, this);
+    return true;
+}
+
+void ConfigWatcher::stop()
+{
+    if (m_isRunning.exchange(false))
+        SetEvent(m_stopEvent);
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    if (m_change != INVALID_HANDLE_VALUE)
+        FindCloseChangeNotification(m_change);
+    if (m_stopEvent != nullptr)
+        CloseHandle(m_stopEvent);
+    m_change = INVALID_HANDLE_VALUE;
+    m_stopEvent = nullptr;
+}
+
+void ConfigWatcher::run()
+{
+    // The notification tells that something in the directory has changed,
+    // the file is only read again if its write time is not the same.
+    HANDLE handles[2] = { m_stopEvent, m_change };
+    while (m_isRunning && WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1)
+    {
+        const unsigned long long writeTime = lastWriteTimeOf(m_path);
+        if (writeTime != 0 && writeTime != m_lastWriteTime)
+        {
+            m_lastWriteTime = writeTime;
+            reload();
+        }
+        if (!FindNextChangeNotification(m_change))
+            break;
+    }
+}
+
+#else
+
+bool ConfigWatcher::start(const std::string& path, std::string& error)
+{
+    stop();
+
+    std::string directory;
+    splitPath(path, directory, m_fileName);
+
+    m_inotify = ::inotify_init1(IN_CLOEXEC);
+    if (m_inotify < 0 || ::pipe(m_wakeUpPipe) != 0)
+    {
+        error = std::string("cannot create the watcher: ") + std::strerror(errno) + ".";
+        stop();
+        return false;
+    }
+
+    // A file written in place, or written elsewhere and renamed.
+    if (::inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        error = "cannot watch " + directory + ": " + std::strerror(errno) + ".";
+        stop();
+        return false;
+    }
+
+    m_isRunning = true;
+    m_thread = std::thread(&ConfigWatcher::run, this);
+    return true;
+}
+
+void ConfigWatcher::stop()
+{
+    // Wake up the thread with the pipe.
+    if (m_isRunning.exchange(false))
+    {
+        const char wakeUp = 0;
+        while (::write(m_wakeUpPipe[1], &wakeUp, 1) < 0 && errno == EINTR)
+        {}
+    }
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    if (m_inotify >= 0)
+        ::close(m_inotify);
+    m_inotify = -1;
+    for (int& fd : m_wakeUpPipe)
+    {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+}
+
+void ConfigWatcher::run()
+{
+    // The events of a read are checked all together, the file is read
+    // once even if it has been written several times.
+    alignas(inotify_event) char buffer[4096];
+    while (m_isRunning)
+    {
+        pollfd fds[2] = {};
+        fds[0].fd = m_inotify;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_wakeUpPipe[0];
+        fds[1].events = POLLIN;
+        if (::poll(fds, 2, -1) < 0 && errno != EINTR)
+            break;
+        if (fds[1].revents != 0 || (fds[0].revents & POLLIN) == 0)
+            continue;
+
+        const ssize_t readSize = ::read(m_inotify, buffer, sizeof(buffer));
+        if (readSize <= 0)
+            continue;
+
+        bool isChanged = false;
+        for (ssize_t offset = 0; offset < readSize;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (event->len > 0 && m_fileName == event->name)
+                isChanged = true;
+            offset += sizeof(inotify_event) + event->len;
+        }
+        if (isChanged)
+            reload();
+    }
+}
+
+#endif
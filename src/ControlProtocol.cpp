@@ -0,0 +1,197 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ControlProtocol.h"
+#include "KeyTable.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace
+{
+    const char* const counterNames = "presses blocked deferred injected cancelled";
+
+    std::string error(const std::string& message)
+    {
+        return "error " + message + "\n";
+    }
+}
+
+ControlTarget::~ControlTarget()
+{}
+
+ControlProtocol::ControlProtocol(ControlTarget& target) :
+    m_target(target)
+{}
+
+std::string ControlProtocol::handle(const std::string& request)
+{
+    std::istringstream stream(request);
+    std::string command;
+    std::string argument;
+    std::string extra;
+    stream >> command >> argument >> extra;
+    if (!extra.empty())
+        return error("too many arguments.");
+
+    if (command == "ping" && argument.empty())
+        return "ok\n";
+    if (command == "stats" && argument.empty())
+        return stats();
+    if (command == "latency" && argument.empty())
+        return latency();
+    if (command == "watchdog" && argument.empty())
+        return watchdog();
+
+    if (command == "time")
+    {
+        if (!argument.empty())
+        {
+            // Like --time, down to the microsecond.
+            char* end = nullptr;
+            const double time = std::strtod(argument.c_str(), &end);
+            if (end == argument.c_str() || *end != '\0' || !isValidChatterTime(time))
+                return error("the time must be between 0.001 and 10000 ms.");
+            m_target.setChatterTime(chatterTimeFromMilliseconds(time));
+        }
+
+        char line[64];
+        std::snprintf(line, sizeof(line), "time %.3f\nok\n", chatterTimeToMilliseconds(m_target.chatterTime()));
+        return line;
+    }
+
+    if (command == "reload" && argument.empty())
+    {
+        std::string reloadError;
+        if (!m_target.reloadConfig(reloadError))
+            return error(reloadError);
+        return "ok\n";
+    }
+
+    if (command == "debug")
+    {
+        if (argument == "on" || argument == "off")
+        {
+            if (!m_target.enableDebug(argument == "on"))
+                return error("no debug output in this program.");
+        }
+        else if (!argument.empty())
+            return error("expected debug on or debug off.");
+        return m_target.isDebugEnabled() ? "debug on\nok\n" : "debug off\nok\n";
+    }
+
+    if (command == "help" && argument.empty())
+        return "requests: ping, stats, latency, watchdog, time [<ms>], reload, debug [on|off], help\nok\n";
+
+    return error("unknown request \"" + request + "\", try help.");
+}
+
+bool ControlProtocol::isLastLine(const std::string& line)
+{
+    return line == "ok" || line.compare(0, 6, "error ") == 0;
+}
+
+std::string ControlProtocol::stats() const
+{
+    const ChatterStatistics* statistics = m_target.statistics();
+    if (statistics == nullptr)
+        return error("no statistics in this program.");
+
+    static const ChatterCounter counters[chatterCounterCount] = {
+        ChatterCounter::PressesSeen,
+        ChatterCounter::PressesBlocked,
+        ChatterCounter::ReleasesDeferred,
+        ChatterCounter::ReleasesInjected,
+        ChatterCounter::ReleasesCancelled
+    };
+
+    std::ostringstream stream;
+    std::uint64_t totals[chatterCounterCount] = {};
+    stream << "# key <code> " << counterNames << " <name>\n";
+
+    // The keys never used are not sent.
+    for (std::size_t key = 0; key < keyTableSize; key++)
+    {
+        std::uint64_t counts[chatterCounterCount];
+        bool isUsed = false;
+        for (std::size_t i = 0; i < chatterCounterCount; i++)
+        {
+            counts[i] = statistics->count(key, counters[i]);
+            totals[i] += counts[i];
+            isUsed = isUsed || counts[i] != 0;
+        }
+        if (!isUsed)
+            continue;
+
+        stream << "key " << key;
+        for (std::size_t i = 0; i < chatterCounterCount; i++)
+            stream << ' ' << counts[i];
+        stream << ' ' << keyName(static_cast<unsigned long>(key)) << '\n';
+    }
+
+    stream << "total";
+    for (std::size_t i = 0; i < chatterCounterCount; i++)
+        stream << ' ' << totals[i];
+    stream << '\n';
+    stream << "batches " << statistics->releaseBatches.load(std::memory_order_relaxed) << '\n';
+    stream << "unknown " << statistics->unknownKeyEvents.load(std::memory_order_relaxed) << '\n';
+    stream << "ok\n";
+    return stream.str();
+}
+
+std::string ControlProtocol::latency() const
+{
+    const HookLatency* hookLatency = m_target.hookLatency();
+    if (hookLatency == nullptr)
+        return error("no latency in this program.");
+
+    static const char* const names[HookLatency::eventTypeCount] = { "press", "release", "blocked", "passed" };
+    static const HookEventType types[HookLatency::eventTypeCount] = {
+        HookEventType::Press, HookEventType::Release, HookEventType::Blocked, HookEventType::Passed
+    };
+
+    std::string response = "# latency <event> <count> <p50> <p99> <p99.9> <max> (us)\n";
+    for (std::size_t i = 0; i < HookLatency::eventTypeCount; i++)
+    {
+        const LatencyHistogram& h = hookLatency->histogram(types[i]);
+        char line[160];
+        std::snprintf(line, sizeof(line), "latency %s %llu %.2f %.2f %.2f %.2f\n", names[i],
+            static_cast<unsigned long long>(h.count()),
+            h.valueAtPercentile(50.).count() / 1000., h.valueAtPercentile(99.).count() / 1000.,
+            h.valueAtPercentile(99.9).count() / 1000., h.max().count() / 1000.);
+        response += line;
+    }
+    response += "ok\n";
+    return response;
+}
+
+std::string ControlProtocol::watchdog() const
+{
+    const HookWatchdog* hookWatchdog = m_target.hookWatchdog();
+    if (hookWatchdog == nullptr)
+        return error("no hook watchdog in this program.");
+
+    std::ostringstream stream;
+    stream << "# watchdog <stalls> <drops> <failed installs>\n";
+    stream << "watchdog " << hookWatchdog->incidentCount(HookIncident::Stall)
+        << ' ' << hookWatchdog->incidentCount(HookIncident::Drop)
+        << ' ' << hookWatchdog->incidentCount(HookIncident::FailedInstall) << '\n';
+    stream << "ok\n";
+    return stream.str();
+}
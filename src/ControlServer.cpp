@@ -0,0 +1,512 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ControlServer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <vector>
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+const std::size_t ControlServer::maxRequestSize;
+
+namespace
+{
+    // Last line of a response, without its new line.
+    std::string lastLineOf(const std::string& response)
+    {
+        std::size_t end = response.size();
+        if (end > 0 && response[end - 1] == '\n')
+            end--;
+        const std::size_t begin = end == 0 ? std::string::npos : response.rfind('\n', end - 1);
+        const std::size_t first = begin == std::string::npos ? 0 : begin + 1;
+        return response.substr(first, end - first);
+    }
+}
+
+ControlServer::ControlServer(ControlTarget& target) :
+    m_protocol(target),
+    m_isRunning(false),
+#ifdef _WIN32
+    m_pipe(INVALID_HANDLE_VALUE),
+    m_threadId(0)
+#else
+    m_socket(-1),
+    m_client(-1)
+#endif
+{
+#ifndef _WIN32
+    m_wakeUpPipe[0] = -1;
+    m_wakeUpPipe[1] = -1;
+#endif
+}
+
+ControlServer::~ControlServer()
+{
+    stop();
+}
+
+bool ControlServer::isRunning() const
+{
+    return m_isRunning;
+}
+
+bool ControlServer::handleInput(const char* data, std::size_t size, std::string& request)
+{
+    /*
+    * Append the data read to the current request. Each complete line is
+    * answered, the rest is kept for the next read. Return false if the
+    * connection must be closed.
+    */
+    for (std::size_t i = 0; i < size; i++)
+    {
+        if (data[i] != '\n')
+        {
+            if (request.size() >= maxRequestSize)
+                return false;
+            request += data[i];
+            continue;
+        }
+
+        if (!request.empty() && request[request.size() - 1] == '\r')
+            request.erase(request.size() - 1);
+        const std::string response = m_protocol.handle(request);
+        request.clear();
+
+#ifdef _WIN32
+        DWORD written = 0;
+        if (!WriteFile(m_pipe, response.data(), static_cast<DWORD>(response.size()), &written, nullptr) ||
+            written != response.size())
+            return false;
+#else
+        std::size_t offset = 0;
+        while (offset < response.size())
+        {
+            const ssize_t written = ::send(m_client, response.data() + offset, response.size() - offset, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                return false;
+            offset += static_cast<std::size_t>(written);
+        }
+#endif
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+namespace
+{
+    /*
+    * Security descriptor giving the pipe to the current user only:
+    * its DACL has one entry, the user of the process token.
+    */
+    class PipeSecurity
+    {
+    public:
+        bool create(std::string& error)
+        {
+            HANDLE token = nullptr;
+            DWORD size = 0;
+            if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token))
+                return fail("cannot open the token of the process", error);
+            GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+            m_tokenUser.resize(size);
+            const bool isRead = size > 0 && GetTokenInformation(token, TokenUser, m_tokenUser.data(), size, &size);
+            CloseHandle(token);
+            if (!isRead)
+                return fail("cannot read the user of the process", error);
+
+            PSID user = reinterpret_cast<TOKEN_USER*>(m_tokenUser.data())->User.Sid;
+            m_acl.resize(sizeof(ACL) + sizeof(ACCESS_ALLOWED_ACE) + GetLengthSid(user));
+            PACL acl = reinterpret_cast<PACL>(m_acl.data());
+            if (!InitializeAcl(acl, static_cast<DWORD>(m_acl.size()), ACL_REVISION) ||
+                !AddAccessAllowedAce(acl, ACL_REVISION, GENERIC_ALL, user) ||
+                !InitializeSecurityDescriptor(&m_descriptor, SECURITY_DESCRIPTOR_REVISION) ||
+                !SetSecurityDescriptorDacl(&m_descriptor, TRUE, acl, FALSE))
+                return fail("cannot create the security descriptor of the pipe", error);
+
+            m_attributes.nLength = sizeof(m_attributes);
+            m_attributes.lpSecurityDescriptor = &m_descriptor;
+            m_attributes.bInheritHandle = FALSE;
+            return true;
+        }
+
+        SECURITY_ATTRIBUTES* attributes()
+        {
+            return &m_attributes;
+        }
+
+    private:
+        bool fail(const char* what, std::string& error)
+        {
+            error = std::string(what) + " (error " + std::to_string(GetLastError()) + ").";
+            return false;
+        }
+
+        std::vector<unsigned char> m_tokenUser;
+        std::vector<unsigned char> m_acl;
+        SECURITY_DESCRIPTOR m_descriptor;
+        SECURITY_ATTRIBUTES m_attributes;
+    };
+}
+
+std::string controlEndpoint(const std::string& name)
+{
+    const std::string prefix = "\\\\.\\pipe\\";
+    if (name.compare(0, prefix.size(), prefix) == 0)
+        return name;
+    return prefix + name;
+}
+
+bool ControlServer::start(const std::string& endpoint, std::string& error)
+{
+    stop();
+    m_endpoint = controlEndpoint(endpoint);
+
+    /*
+    * The only instance of the pipe is created here and kept until the server
+    * stops, so no other process can take its name between two clients.
+    * It must be the first instance of the name, only the current user can
+    * open it, and the clients of other computers are rejected.
+    */
+    PipeSecurity security;
+    if (!security.create(error))
+        return false;
+    m_pipe = CreateNamedPipeA(m_endpoint.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 4096, 4096, 0, security.attributes());
+    if (m_pipe == INVALID_HANDLE_VALUE)
+    {
+        const DWORD lastError = GetLastError();
+        if (lastError == ERROR_ACCESS_DENIED)
+            error = "the pipe " + m_endpoint + " is already used by another process.";
+        else
+            error = "cannot create the pipe " + m_endpoint + " (error " + std::to_string(lastError) + ").";
+        return false;
+    }
+
+    m_isRunning = true;
+    m_thread = std::thread(&ControlServer::run, this);
+    return true;
+}
+
+void ControlServer::stop()
+{
+    /*
+    * The thread is blocked waiting for a client or reading one.
+    * Its blocking call is cancelled, and a connection is made in case
+    * the thread was between two calls, so it sees the end of the server.
+    */
+    if (!m_isRunning.exchange(false))
+        return;
+
+    HANDLE thread = OpenThread(THREAD_TERMINATE, FALSE, m_threadId);
+    if (thread != nullptr)
+    {
+        CancelSynchronousIo(thread);
+        CloseHandle(thread);
+    }
+    HANDLE client = CreateFileA(m_endpoint.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (client != INVALID_HANDLE_VALUE)
+        CloseHandle(client);
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void ControlServer::run()
+{
+    m_threadId = GetCurrentThreadId();
+    while (m_isRunning)
+    {
+        // A client connected before the call is reported by ERROR_PIPE_CONNECTED,
+        // a client gone before it by ERROR_NO_DATA.
+        const bool isConnected = ConnectNamedPipe(m_pipe, nullptr) != FALSE;
+        const DWORD lastError = isConnected ? ERROR_SUCCESS : GetLastError();
+        if (isConnected || lastError == ERROR_PIPE_CONNECTED)
+        {
+            if (m_isRunning)
+                serveClient();
+            FlushFileBuffers(m_pipe);
+        }
+        else if (lastError != ERROR_NO_DATA)
+            break;
+
+        // The same instance waits for the next client.
+        DisconnectNamedPipe(m_pipe);
+    }
+
+    CloseHandle(m_pipe);
+    m_pipe = INVALID_HANDLE_VALUE;
+}
+
+void ControlServer::serveClient()
+{
+    std::string request;
+    char buffer[512];
+    DWORD readSize = 0;
+    while (m_isRunning && ReadFile(m_pipe, buffer, sizeof(buffer), &readSize, nullptr) && readSize > 0)
+    {
+        if (!handleInput(buffer, readSize, request))
+            break;
+    }
+}
+
+bool sendControlRequest(const std::string& endpoint, const std::string& request, std::string& response, std::string& error)
+{
+    const std::string name = controlEndpoint(endpoint);
+    HANDLE pipe = CreateFileA(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE)
+    {
+        error = "cannot connect to " + name + " (error " + std::to_string(GetLastError()) + ").";
+        return false;
+    }
+
+    const std::string line = request + "\n";
+    DWORD size = 0;
+    bool isDone = WriteFile(pipe, line.data(), static_cast<DWORD>(line.size()), &size, nullptr) != FALSE;
+
+    // A pipe cannot be half closed, read until the last line of the response.
+    response.clear();
+    char buffer[512];
+    while (isDone && ReadFile(pipe, buffer, sizeof(buffer), &size, nullptr) && size > 0)
+    {
+        response.append(buffer, size);
+        if (response[response.size() - 1] == '\n' && ControlProtocol::isLastLine(lastLineOf(response)))
+            break;
+    }
+    CloseHandle(pipe);
+
+    if (!ControlProtocol::isLastLine(lastLineOf(response)))
+    {
+        error = "no response from " + name + ".";
+        return false;
+    }
+    return true;
+}
+
+#else
+
+std::string controlEndpoint(const std::string& name)
+{
+    return name;
+}
+
+bool ControlServer::start(const std::string& endpoint, std::string& error)
+{
+    stop();
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (endpoint.empty() || endpoint.size() >= sizeof(address.sun_path))
+    {
+        error = "invalid socket path " + endpoint + ".";
+        return false;
+    }
+    std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+
+    m_socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_socket < 0 || ::pipe(m_wakeUpPipe) != 0)
+    {
+        error = std::string("cannot create the socket: ") + std::strerror(errno) + ".";
+        stop();
+        return false;
+    }
+
+    // A socket left by a previous instance is replaced, never another file,
+    // nor the socket of an instance still running: it answers the connection.
+    struct stat fileStat = {};
+    if (::lstat(endpoint.c_str(), &fileStat) == 0 && S_ISSOCK(fileStat.st_mode))
+    {
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const bool isLive = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        const int connectError = errno;
+        if (probe >= 0)
+            ::close(probe);
+        if (isLive || connectError != ECONNREFUSED)
+        {
+            error = isLive ? "the socket " + endpoint + " is already used by another process." :
+                "cannot check the socket " + endpoint + ": " + std::strerror(connectError) + ".";
+            stop();
+            return false;
+        }
+        ::unlink(endpoint.c_str());
+    }
+
+    // The socket is created without any access for the others, then restricted
+    // again below, so no other user can connect in between.
+    const mode_t previousMask = ::umask(077);
+    const int bindResult = ::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    const int bindError = errno;
+    ::umask(previousMask);
+    if (bindResult != 0)
+    {
+        error = "cannot listen on " + endpoint + ": " + std::strerror(bindError) + ".";
+        stop();
+        return false;
+    }
+
+    // The socket file now belongs to this server. Only the user running the program can connect.
+    m_endpoint = endpoint;
+    if (::chmod(endpoint.c_str(), 0600) != 0 || ::listen(m_socket, 4) != 0)
+    {
+        error = "cannot listen on " + endpoint + ": " + std::strerror(errno) + ".";
+        stop();
+        return false;
+    }
+
+    m_isRunning = true;
+    m_thread = std::thread(&ControlServer::run, this);
+    return true;
+}
+
+void ControlServer::stop()
+{
+    // Wake up the thread with the pipe, it is waiting for a client or for a request.
+    if (m_isRunning.exchange(false))
+    {
+        const char wakeUp = 0;
+        while (::write(m_wakeUpPipe[1], &wakeUp, 1) < 0 && errno == EINTR)
+        {}
+    }
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    // The socket file is only removed if it was created by this server.
+    if (m_socket >= 0)
+        ::close(m_socket);
+    if (!m_endpoint.empty())
+        ::unlink(m_endpoint.c_str());
+    m_endpoint.clear();
+    for (int& fd : m_wakeUpPipe)
+    {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+    m_socket = -1;
+}
+
+void ControlServer::run()
+{
+    while (m_isRunning)
+    {
+        pollfd fds[2] = {};
+        fds[0].fd = m_socket;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_wakeUpPipe[0];
+        fds[1].events = POLLIN;
+        if (::poll(fds, 2, -1) < 0 && errno != EINTR)
+            break;
+        if (fds[1].revents != 0 || (fds[0].revents & POLLIN) == 0)
+            continue;
+
+        m_client = ::accept(m_socket, nullptr, nullptr);
+        if (m_client < 0)
+            continue;
+        serveClient();
+        ::close(m_client);
+        m_client = -1;
+    }
+}
+
+void ControlServer::serveClient()
+{
+    std::string request;
+    char buffer[512];
+    while (m_isRunning)
+    {
+        pollfd fds[2] = {};
+        fds[0].fd = m_client;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_wakeUpPipe[0];
+        fds[1].events = POLLIN;
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (fds[1].revents != 0)
+            return;
+
+        const ssize_t readSize = ::recv(m_client, buffer, sizeof(buffer), 0);
+        if (readSize < 0 && errno == EINTR)
+            continue;
+        if (readSize <= 0 || !handleInput(buffer, static_cast<std::size_t>(readSize), request))
+            return;
+    }
+}
+
+bool sendControlRequest(const std::string& endpoint, const std::string& request, std::string& response, std::string& error)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (endpoint.empty() || endpoint.size() >= sizeof(address.sun_path))
+    {
+        error = "invalid socket path " + endpoint + ".";
+        return false;
+    }
+    std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        error = "cannot connect to " + endpoint + ": " + std::strerror(errno) + ".";
+        if (fd >= 0)
+            ::close(fd);
+        return false;
+    }
+
+    // The end of the request tells the server there is nothing more to answer.
+    const std::string line = request + "\n";
+    bool isSent = ::send(fd, line.data(), line.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(line.size());
+    ::shutdown(fd, SHUT_WR);
+
+    response.clear();
+    char buffer[512];
+    ssize_t readSize = 0;
+    while (isSent && ((readSize = ::recv(fd, buffer, sizeof(buffer), 0)) > 0 || (readSize < 0 && errno == EINTR)))
+    {
+        if (readSize > 0)
+            response.append(buffer, static_cast<std::size_t>(readSize));
+    }
+    ::close(fd);
+
+    // The response must end with its last line.
+    if (!isSent || !ControlProtocol::isLastLine(lastLineOf(response)))
+    {
+        error = "no response from " + endpoint + ".";
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DebugLog.h"
+#include "KeyTable.h"
+
+DebugLog::DebugLog(std::ostream& stream) :
+    m_stream(stream),
+    m_droppedCount(0),
+    m_reportedDroppedCount(0),
+    m_isWriterSleeping(false),
+    m_isRunning(true)
+{
+    for (std::size_t i = 0; i < sourceCount; i++)
+        m_isPushing[i] = false;
+    m_thread = std::thread(&DebugLog::run, this);
+}
+
+DebugLog::~DebugLog()
+{
+    stop();
+}
+
+bool DebugLog::log(DebugLogSource source, const DebugRecord& record)
+{
+    // Push the record, or drop it if the writer is late or if another
+    // thread of the same source is pushing. The flag orders the pushes
+    // of two producers, the ring keeps a single one at a time.
+    const std::size_t index = static_cast<std::size_t>(source);
+    if (m_isPushing[index].exchange(true, std::memory_order_acquire))
+    {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const bool isPushed = m_rings[index].push(record);
+    m_isPushing[index].store(false, std::memory_order_release);
+    if (!isPushed)
+    {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Only wake up the writer if it is sleeping. The fence orders the push
+    // before reading the flag, the writer does the opposite before sleeping,
+    // so at least one of them sees the other.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_isWriterSleeping.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_condition.notify_one();
+    }
+
+    return true;
+}
+
+std::uint64_t DebugLog::droppedCount() const
+{
+    return m_droppedCount.load(std::memory_order_relaxed);
+}
+
+void DebugLog::stop()
+{
+    // Ask the writer to exit, it writes the remaining records first.
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_isRunning = false;
+        m_condition.notify_one();
+    }
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void DebugLog::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (m_isRunning)
+    {
+        lock.unlock();
+        writeRecords();
+        lock.lock();
+
+        m_isWriterSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_isRunning && isEmpty())
+            m_condition.wait(lock);
+        m_isWriterSleeping.store(false, std::memory_order_relaxed);
+    }
+
+    lock.unlock();
+    writeRecords();
+}
+
+bool DebugLog::isEmpty() const
+{
+    for (std::size_t i = 0; i < sourceCount; i++)
+    {
+        if (!m_rings[i].isEmpty())
+            return false;
+    }
+    return true;
+}
+
+void DebugLog::writeRecords()
+{
+    DebugRecord record;
+    bool isWritten = false;
+    for (std::size_t i = 0; i < sourceCount; i++)
+    {
+        while (m_rings[i].pop(record))
+        {
+            writeRecord(record);
+            isWritten = true;
+        }
+    }
+
+    // Report the records dropped since the last time.
+    std::uint64_t dropped = droppedCount();
+    if (dropped != m_reportedDroppedCount)
+    {
+        m_stream << dropped - m_reportedDroppedCount << " debug messages dropped." << '\n';
+        m_reportedDroppedCount = dropped;
+        isWritten = true;
+    }
+
+    if (isWritten)
+        m_stream.flush();
+}
+
+void DebugLog::writeRecord(const DebugRecord& record)
+{
+    switch (record.type)
+    {
+    case DebugRecordType::Chatter:
+        m_stream << "Chatter on " << keyName(record.key) << " key. Time since last press: "
+            << chatterTimeToMilliseconds(record.timeSinceLastPress) << " ms." << '\n';
+        break;
+    case DebugRecordType::ReleaseFailed:
+        m_stream << "Failed to release the " << keyName(record.key) << " key." << '\n';
+        break;
+    }
+}
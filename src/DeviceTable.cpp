@@ -0,0 +1,147 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DeviceTable.h"
+
+const std::size_t DeviceTable::noTable;
+
+DeviceTable::DeviceTable(std::size_t tableCount)
+{
+    if (tableCount == 0)
+        tableCount = 1;
+
+    // A power of two, so the position of a device is a mask of its hash.
+    std::size_t entryCount = 4;
+    while (entryCount < tableCount * 4)
+        entryCount *= 2;
+
+    Entry emptyEntry = {};
+    emptyEntry.table = -1;
+    m_entries.assign(entryCount, emptyEntry);
+    m_devices.assign(tableCount, defaultDevice);
+    m_isUsed.assign(tableCount, false);
+
+    // The tables are given from the first one.
+    for (std::size_t i = tableCount; i > 0; i--)
+        m_freeTables.push_back(i - 1);
+
+    bool isNew = false;
+    acquire(defaultDevice, isNew);
+}
+
+std::size_t DeviceTable::find(DeviceId device) const
+{
+    const std::size_t mask = m_entries.size() - 1;
+    for (std::size_t i = position(device); m_entries[i].table >= 0; i = (i + 1) & mask)
+    {
+        if (m_entries[i].device == device)
+            return static_cast<std::size_t>(m_entries[i].table);
+    }
+    return noTable;
+}
+
+std::size_t DeviceTable::acquire(DeviceId device, bool& isNew)
+{
+    // Linear probing until the device or an empty entry is found.
+    const std::size_t mask = m_entries.size() - 1;
+    std::size_t i = position(device);
+    for (; m_entries[i].table >= 0; i = (i + 1) & mask)
+    {
+        if (m_entries[i].device == device)
+        {
+            isNew = false;
+            return static_cast<std::size_t>(m_entries[i].table);
+        }
+    }
+
+    if (m_freeTables.empty())
+        return noTable;
+
+    const std::size_t table = m_freeTables.back();
+    m_freeTables.pop_back();
+    m_entries[i].device = device;
+    m_entries[i].table = static_cast<std::int32_t>(table);
+    m_devices[table] = device;
+    m_isUsed[table] = true;
+    isNew = true;
+    return table;
+}
+
+bool DeviceTable::release(DeviceId device)
+{
+    // The default device keeps its table.
+    if (device == defaultDevice)
+        return false;
+
+    const std::size_t mask = m_entries.size() - 1;
+    std::size_t i = position(device);
+    while (m_entries[i].table >= 0 && m_entries[i].device != device)
+        i = (i + 1) & mask;
+    if (m_entries[i].table < 0)
+        return false;
+
+    const std::size_t table = static_cast<std::size_t>(m_entries[i].table);
+    m_isUsed[table] = false;
+    m_freeTables.push_back(table);
+
+    /*
+    * Remove the entry without leaving a hole in the probing sequences:
+    * the following entries that could be stored at the place of the removed
+    * one are moved back, until an empty entry is found.
+    */
+    std::size_t hole = i;
+    for (std::size_t j = (hole + 1) & mask; m_entries[j].table >= 0; j = (j + 1) & mask)
+    {
+        const std::size_t home = position(m_entries[j].device);
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            m_entries[hole] = m_entries[j];
+            hole = j;
+        }
+    }
+    m_entries[hole].table = -1;
+    return true;
+}
+
+DeviceId DeviceTable::device(std::size_t table) const
+{
+    return table < m_devices.size() ? m_devices[table] : defaultDevice;
+}
+
+bool DeviceTable::isUsed(std::size_t table) const
+{
+    return table < m_isUsed.size() && m_isUsed[table];
+}
+
+std::size_t DeviceTable::tableCount() const
+{
+    return m_devices.size();
+}
+
+std::size_t DeviceTable::usedCount() const
+{
+    return m_devices.size() - m_freeTables.size();
+}
+
+std::size_t DeviceTable::position(DeviceId device) const
+{
+    // The handles and the device numbers are often multiples of a power of two, mix the bits.
+    std::uint64_t hash = device * UINT64_C(0x9E3779B97F4A7C15);
+    hash ^= hash >> 32;
+    return static_cast<std::size_t>(hash) & (m_entries.size() - 1);
+}
@@ -0,0 +1,66 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "HookEventFilter.h"
+
+HookEventFilter::HookEventFilter(ReleaseScheduler& releaseScheduler, HookWatchdog& hookWatchdog, DebugLog& debugLog,
+    KeyEventRecorder& recorder, const std::atomic<bool>& isDebugEnabled) :
+    m_releaseScheduler(releaseScheduler),
+    m_hookWatchdog(hookWatchdog),
+    m_debugLog(debugLog),
+    m_recorder(recorder),
+    m_isDebugEnabled(isDebugEnabled)
+{}
+
+ChatterDecision HookEventFilter::filter(unsigned long key, bool isPressed, bool isInjected, bool isOwnRelease, ChatterTime time)
+{
+    // Ask the engine if the event is a chatter. A chattering press is
+    // discarded and a release too close to the press is delayed.
+    // The watchdog is told when the callback starts and ends, a slow callback is dropped by Windows.
+    m_hookWatchdog.enterCallback(time);
+    ChatterResult result = m_releaseScheduler.processKeyEvent(key, isPressed, time);
+
+    // The debug message is written by another thread.
+    if (result.decision == ChatterDecision::Block && m_isDebugEnabled)
+    {
+        DebugRecord record = {};
+        record.time = time;
+        record.timeSinceLastPress = result.timeSinceLastPress;
+        record.key = key;
+        record.type = DebugRecordType::Chatter;
+        record.decision = result.decision;
+        m_debugLog.log(DebugLogSource::Hook, record);
+    }
+
+    // The recording is written by another thread too.
+    if (m_recorder.isOpen())
+    {
+        KeyEventRecord record = {};
+        record.time = time;
+        record.device = defaultDevice;
+        record.key = key;
+        record.isPressed = isPressed;
+        record.isInjected = isInjected;
+        record.isOwnRelease = isOwnRelease;
+        record.decision = result.decision;
+        m_recorder.record(record);
+    }
+
+    m_hookWatchdog.leaveCallback(time);
+    return result.decision;
+}
@@ -0,0 +1,293 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "HookWatchdog.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+
+namespace
+{
+    const ChatterTime::rep noCallback = std::numeric_limits<ChatterTime::rep>::min();
+}
+
+WatchedHook::~WatchedHook()
+{}
+
+HookWatchdog::HookWatchdog(const ChatterClock& clock, std::ostream& log) :
+    m_clock(clock),
+    m_log(log),
+    m_hook(nullptr),
+    m_settings(),
+    m_callbackStartTime(noCallback),
+    m_lastCallbackTime(noCallback),
+    m_isProbeAnswered(false),
+    m_isIdle(false),
+    m_callbackBeforeEvent(noCallback),
+    m_isCallbackExpected(false),
+    m_lastSeenCallback(noCallback),
+    m_stalledCallback(noCallback),
+    m_slowCallback(noCallback),
+    m_callbackBeforeWait(noCallback),
+    m_lastAliveTime(ChatterTime::zero()),
+    m_probeTime(ChatterTime::zero()),
+    m_expectTime(ChatterTime::zero()),
+    m_isProbing(false),
+    m_isWaitingCallback(false),
+    m_isRunning(false)
+{
+    for (std::size_t i = 0; i < incidentTypeCount; i++)
+        m_incidents[i] = 0;
+}
+
+HookWatchdog::~HookWatchdog()
+{
+    stop();
+}
+
+void HookWatchdog::start(WatchedHook& hook, const HookWatchdogSettings& settings)
+{
+    stop();
+
+    m_hook = &hook;
+    m_settings = settings;
+    m_lastSeenCallback = m_lastCallbackTime;
+    m_stalledCallback = noCallback;
+    m_slowCallback = noCallback;
+    m_lastAliveTime = m_clock.now();
+    m_isProbing = false;
+    m_isWaitingCallback = false;
+    m_isCallbackExpected = false;
+    m_isRunning = true;
+    m_thread = std::thread(&HookWatchdog::run, this);
+}
+
+void HookWatchdog::stop()
+{
+    // Ask the thread to exit and wait for it.
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_isRunning = false;
+        m_condition.notify_one();
+    }
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+bool HookWatchdog::isRunning() const
+{
+    return m_isRunning;
+}
+
+void HookWatchdog::enterCallback(ChatterTime startTime)
+{
+    // The time of the last callback is stored before reading the idle flag,
+    // and the watchdog sets the flag before reading the time: either the
+    // watchdog sees the callback, or the callback wakes the watchdog up.
+    m_callbackStartTime.store(startTime.count(), std::memory_order_relaxed);
+    m_lastCallbackTime.store(startTime.count());
+    wakeUp();
+}
+
+void HookWatchdog::leaveCallback(ChatterTime startTime)
+{
+    // After a stall, the callback of the new hook may already be running.
+    ChatterTime::rep expected = startTime.count();
+    m_callbackStartTime.compare_exchange_strong(expected, noCallback);
+}
+
+void HookWatchdog::answerProbe()
+{
+    m_isProbeAnswered = true;
+}
+
+void HookWatchdog::expectCallback()
+{
+    // The last callback is taken before the event is sent,
+    // any other callback after it proves the hook is alive.
+    m_callbackBeforeEvent.store(m_lastCallbackTime.load(), std::memory_order_relaxed);
+    m_isCallbackExpected.store(true);
+    wakeUp();
+}
+
+std::uint64_t HookWatchdog::incidentCount(HookIncident incident) const
+{
+    return m_incidents[static_cast<std::size_t>(incident)].load(std::memory_order_relaxed);
+}
+
+void HookWatchdog::print(std::ostream& stream) const
+{
+    stream << "Hook watchdog: " << incidentCount(HookIncident::Stall) << " stalls, "
+        << incidentCount(HookIncident::Drop) << " drops, "
+        << incidentCount(HookIncident::FailedInstall) << " failed installs." << std::endl;
+}
+
+void HookWatchdog::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (m_isRunning)
+    {
+        // The hook is installed again without the lock, so a callback
+        // of the new hook never waits for the watchdog.
+        lock.unlock();
+        const ChatterTime now = m_clock.now();
+        const ChatterTime wakeUpTime = check(now);
+        lock.lock();
+
+        // Idle: the flag is set before reading what would wake the watchdog up.
+        const bool isIdle = wakeUpTime == ChatterTime::max();
+        if (isIdle)
+        {
+            m_isIdle = true;
+            if (m_lastCallbackTime.load() != m_lastSeenCallback || m_isCallbackExpected.load())
+            {
+                m_isIdle = false;
+                continue;
+            }
+        }
+
+        if (m_isRunning && isIdle)
+            m_condition.wait(lock);
+        else if (m_isRunning && wakeUpTime > now)
+            m_condition.wait_for(lock, wakeUpTime - now);
+        m_isIdle = false;
+    }
+}
+
+void HookWatchdog::wakeUp()
+{
+    if (m_isIdle.load() && m_isIdle.exchange(false))
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_condition.notify_one();
+    }
+}
+
+ChatterTime HookWatchdog::check(ChatterTime now)
+{
+    /*
+    * Return the time of the next check, ChatterTime::max() when idle.
+    * A callback running since half of the timeout is a stall: the system
+    * drops the hook at the timeout, the new hook is installed before.
+    * A callback running since a quarter of the timeout, a callback seen
+    * half of the timeout after its event, or an expected callback missing
+    * are doubts: the hook is probed once, and installed again if the probe
+    * is not answered.
+    */
+    const ChatterTime stallTime = m_settings.hookTimeout / 2;
+    const ChatterTime slowTime = m_settings.hookTimeout / 4;
+    // The probe goes through the input queue of the system,
+    // it is given twice the timeout of the hook to be answered.
+    const ChatterTime answerTime = m_settings.hookTimeout * 2;
+    bool isDoubtful = false;
+
+    const ChatterTime::rep startTime = m_callbackStartTime.load();
+    if (startTime != noCallback && startTime != m_stalledCallback && now - ChatterTime(startTime) >= stallTime)
+    {
+        // The new hook is not probed for the doubts about the stalled one.
+        m_stalledCallback = startTime;
+        m_isProbing = false;
+        m_isWaitingCallback = false;
+        reinstall(HookIncident::Stall, now - ChatterTime(startTime));
+    }
+    else if (startTime != noCallback && startTime != m_stalledCallback && startTime != m_slowCallback &&
+        now - ChatterTime(startTime) >= slowTime)
+    {
+        m_slowCallback = startTime;
+        isDoubtful = true;
+    }
+
+    const ChatterTime::rep lastCallbackTime = m_lastCallbackTime.load();
+    const bool isBusy = startTime != noCallback || lastCallbackTime != m_lastSeenCallback;
+    if (lastCallbackTime != m_lastSeenCallback)
+    {
+        if (lastCallbackTime != m_stalledCallback && lastCallbackTime != m_slowCallback &&
+            now - ChatterTime(lastCallbackTime) >= stallTime)
+            isDoubtful = true;
+        m_lastSeenCallback = lastCallbackTime;
+        m_lastAliveTime = std::max(m_lastAliveTime, ChatterTime(lastCallbackTime));
+    }
+
+    // An event sent by the program must reach the hook.
+    if (m_isCallbackExpected.exchange(false) && !m_isWaitingCallback)
+    {
+        m_isWaitingCallback = true;
+        m_callbackBeforeWait = m_callbackBeforeEvent.load(std::memory_order_relaxed);
+        m_expectTime = now;
+    }
+    if (m_isWaitingCallback && lastCallbackTime != m_callbackBeforeWait)
+        m_isWaitingCallback = false;
+    else if (m_isWaitingCallback && now - m_expectTime >= answerTime)
+    {
+        m_isWaitingCallback = false;
+        isDoubtful = true;
+    }
+
+    if (m_isProbing && m_isProbeAnswered)
+    {
+        m_isProbing = false;
+        m_lastAliveTime = now;
+    }
+    else if (m_isProbing && now - m_probeTime >= answerTime)
+    {
+        const ChatterTime silentTime = now - m_lastAliveTime;
+        m_isProbing = false;
+        m_isWaitingCallback = false;
+        m_lastAliveTime = now;
+        reinstall(HookIncident::Drop, silentTime);
+    }
+    else if (!m_isProbing && isDoubtful)
+    {
+        m_isProbing = true;
+        m_isProbeAnswered = false;
+        m_probeTime = now;
+        m_hook->probe();
+    }
+
+    ChatterTime wakeUpTime = ChatterTime::max();
+    if (m_isProbing)
+        wakeUpTime = m_probeTime + answerTime;
+    if (m_isWaitingCallback)
+        wakeUpTime = std::min(wakeUpTime, m_expectTime + answerTime);
+    if (isBusy)
+        wakeUpTime = std::min(wakeUpTime, now + std::max(slowTime, ChatterTime(1)));
+    return wakeUpTime;
+}
+
+void HookWatchdog::reinstall(HookIncident incident, ChatterTime duration)
+{
+    m_incidents[static_cast<std::size_t>(incident)]++;
+    std::ios::fmtflags flags = m_log.flags();
+    m_log << std::fixed << std::setprecision(1);
+    if (incident == HookIncident::Stall)
+        m_log << "The keyboard hook is stalled since " << chatterTimeToMilliseconds(duration) << " ms";
+    else
+        m_log << "The keyboard hook was dropped, no callback since " << chatterTimeToMilliseconds(duration) << " ms";
+    m_log.flags(flags);
+
+    if (m_hook->reinstall())
+    {
+        m_log << ", it is installed again." << std::endl;
+        return;
+    }
+    m_incidents[static_cast<std::size_t>(HookIncident::FailedInstall)]++;
+    m_log << ", it cannot be installed again." << std::endl;
+}
@@ -0,0 +1,506 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "KeyEventRecording.h"
+
+#include <cstring>
+#include <ctime>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace
+{
+    // A block not full is written this long after its first record.
+    const std::chrono::seconds flushInterval(1);
+
+    void putVarint(std::vector<unsigned char>& buffer, std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<unsigned char>(value));
+    }
+
+    // Small negative numbers are small varints too.
+    std::uint64_t zigzag(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    std::int64_t unzigzag(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    std::uint8_t flagBit(KeyEventRecordFlag flag)
+    {
+        return static_cast<std::uint8_t>(flag);
+    }
+}
+
+KeyEventRecorder::KeyEventRecorder() :
+    m_isPushing(false),
+    m_lastTime(ChatterTime::zero()),
+    m_recordedCount(0),
+    m_droppedCount(0),
+    m_isWriterSleeping(false),
+    m_isFailed(false),
+    m_isRunning(false)
+{}
+
+KeyEventRecorder::~KeyEventRecorder()
+{
+    close();
+}
+
+bool KeyEventRecorder::open(const std::string& path, std::string& error)
+{
+    close();
+
+    m_file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_file)
+    {
+        error = "cannot create " + path + ".";
+        return false;
+    }
+
+    KeyEventRecordingHeader header = {};
+    header.magic = keyEventRecordingMagic;
+    header.version = keyEventRecordingVersion;
+    header.size = sizeof(KeyEventRecordingHeader);
+    header.startTime = static_cast<std::int64_t>(std::time(nullptr));
+#ifdef _WIN32
+    header.processId = static_cast<std::uint32_t>(GetCurrentProcessId());
+#else
+    header.processId = static_cast<std::uint32_t>(::getpid());
+#endif
+    header.timeUnit = 1000;
+    if (!m_file.write(reinterpret_cast<const char*>(&header), sizeof(header)) || !m_file.flush())
+    {
+        error = "cannot write " + path + ".";
+        m_file.close();
+        return false;
+    }
+
+    m_path = path;
+    m_buffer.reserve(bufferSize + 64);
+    m_lastTime = ChatterTime::zero();
+    m_recordedCount = 0;
+    m_droppedCount = 0;
+    m_isFailed = false;
+    m_isRunning = true;
+    m_thread = std::thread(&KeyEventRecorder::run, this);
+    return true;
+}
+
+void KeyEventRecorder::close()
+{
+    // Ask the writer to exit, it writes the remaining records first.
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_isRunning = false;
+        m_condition.notify_one();
+    }
+
+    if (m_thread.joinable())
+        m_thread.join();
+    if (m_file.is_open())
+        m_file.close();
+}
+
+bool KeyEventRecorder::isOpen() const
+{
+    return m_file.is_open();
+}
+
+bool KeyEventRecorder::record(const KeyEventRecord& record)
+{
+    // Push the record, or drop it if the writer is late or if another
+    // hook thread is pushing. The flag orders the pushes of two producers.
+    if (m_isPushing.exchange(true, std::memory_order_acquire))
+    {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const bool isPushed = m_ring.push(record);
+    m_isPushing.store(false, std::memory_order_release);
+    if (!isPushed)
+    {
+        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Only wake up the writer if it is sleeping without a block to write,
+    // otherwise it takes the records when it writes the block. The fence
+    // orders the push before reading the flag, the writer does the opposite.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_isWriterSleeping.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_condition.notify_one();
+    }
+
+    return true;
+}
+
+std::uint64_t KeyEventRecorder::recordedCount() const
+{
+    return m_recordedCount.load(std::memory_order_relaxed);
+}
+
+std::uint64_t KeyEventRecorder::droppedCount() const
+{
+    return m_droppedCount.load(std::memory_order_relaxed);
+}
+
+void KeyEventRecorder::print(std::ostream& stream) const
+{
+    if (m_path.empty())
+        return;
+    stream << "Recorded " << recordedCount() << " key events into " << m_path;
+    if (droppedCount() > 0)
+        stream << ", " << droppedCount() << " dropped";
+    if (m_isFailed)
+        stream << ", the file could not be written";
+    stream << "." << std::endl;
+}
+
+void KeyEventRecorder::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (m_isRunning)
+    {
+        lock.unlock();
+        encodeRecords();
+        const bool isBlockDue = !m_buffer.empty() &&
+            std::chrono::steady_clock::now() - m_bufferTime >= flushInterval;
+        if (m_buffer.size() >= bufferSize || isBlockDue)
+            writeBuffer();
+        lock.lock();
+
+        // With a block waiting, sleep until it is due without being woken up.
+        if (!m_buffer.empty())
+        {
+            if (m_isRunning)
+                m_condition.wait_until(lock, m_bufferTime + flushInterval);
+            continue;
+        }
+
+        m_isWriterSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_isRunning && m_ring.isEmpty())
+            m_condition.wait(lock);
+        m_isWriterSleeping.store(false, std::memory_order_relaxed);
+    }
+
+    lock.unlock();
+    encodeRecords();
+    writeBuffer();
+}
+
+void KeyEventRecorder::encodeRecords()
+{
+    KeyEventRecord record;
+    while (m_buffer.size() < bufferSize && m_ring.pop(record))
+    {
+        if (m_buffer.empty())
+            m_bufferTime = std::chrono::steady_clock::now();
+
+        std::uint8_t flags = 0;
+        if (record.isPressed)
+            flags |= flagBit(KeyEventRecordFlag::Pressed);
+        if (record.isInjected)
+            flags |= flagBit(KeyEventRecordFlag::Injected);
+        if (record.isOwnRelease)
+            flags |= flagBit(KeyEventRecordFlag::OwnRelease);
+        if (record.device != defaultDevice)
+            flags |= flagBit(KeyEventRecordFlag::Device);
+
+        putVarint(m_buffer, zigzag((record.time - m_lastTime).count()));
+        putVarint(m_buffer, record.key);
+        m_buffer.push_back(flags);
+        m_buffer.push_back(static_cast<unsigned char>(record.decision));
+        if (record.device != defaultDevice)
+            putVarint(m_buffer, record.device);
+        m_lastTime = record.time;
+        m_recordedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void KeyEventRecorder::writeBuffer()
+{
+    // After a write error, the records are only counted.
+    if (!m_buffer.empty() && !m_isFailed)
+    {
+        m_file.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()));
+        m_file.flush();
+        m_isFailed = !m_file;
+    }
+    m_buffer.clear();
+}
+
+KeyEventRecordingFile::Cursor::Cursor(const unsigned char* begin, const unsigned char* end) :
+    m_position(begin),
+    m_end(end),
+    m_time(ChatterTime::zero()),
+    m_isTruncated(false)
+{}
+
+bool KeyEventRecordingFile::Cursor::next(KeyEventRecord& record)
+{
+    if (m_position == m_end)
+        return false;
+
+    const unsigned char* start = m_position;
+    std::uint64_t timeDelta = 0;
+    std::uint64_t key = 0;
+    std::uint64_t device = defaultDevice;
+    bool isComplete = readVarint(timeDelta) && readVarint(key) && m_end - m_position >= 2;
+    std::uint8_t flags = 0;
+    if (isComplete)
+    {
+        flags = m_position[0];
+        record.decision = static_cast<ChatterDecision>(m_position[1]);
+        m_position += 2;
+        if ((flags & flagBit(KeyEventRecordFlag::Device)) != 0)
+            isComplete = readVarint(device);
+    }
+
+    if (!isComplete)
+    {
+        m_position = start;
+        m_isTruncated = true;
+        return false;
+    }
+
+    m_time += ChatterTime(unzigzag(timeDelta));
+    record.time = m_time;
+    record.key = static_cast<unsigned long>(key);
+    record.device = static_cast<DeviceId>(device);
+    record.isPressed = (flags & flagBit(KeyEventRecordFlag::Pressed)) != 0;
+    record.isInjected = (flags & flagBit(KeyEventRecordFlag::Injected)) != 0;
+    record.isOwnRelease = (flags & flagBit(KeyEventRecordFlag::OwnRelease)) != 0;
+    return true;
+}
+
+bool KeyEventRecordingFile::Cursor::isTruncated() const
+{
+    return m_isTruncated;
+}
+
+bool KeyEventRecordingFile::Cursor::readVarint(std::uint64_t& value)
+{
+    value = 0;
+    for (unsigned int shift = 0; m_position != m_end && shift < 64; shift += 7)
+    {
+        const unsigned char byte = *m_position++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+KeyEventRecordingFile::KeyEventRecordingFile() :
+    m_data(nullptr),
+    m_size(0),
+#ifdef _WIN32
+    m_file(INVALID_HANDLE_VALUE),
+    m_mapping(nullptr)
+#else
+    m_file(-1)
+#endif
+{}
+
+KeyEventRecordingFile::~KeyEventRecordingFile()
+{
+    close();
+}
+
+bool KeyEventRecordingFile::open(const std::string& path, std::string& error)
+{
+    close();
+    if (!map(path, error))
+        return false;
+
+    // The header is checked before the records are read.
+    const KeyEventRecordingHeader& fileHeader = header();
+    if (fileHeader.magic != keyEventRecordingMagic)
+        error = path + " is not a key event recording.";
+    else if (fileHeader.version != keyEventRecordingVersion || fileHeader.size < sizeof(KeyEventRecordingHeader) ||
+            fileHeader.size > m_size || fileHeader.timeUnit != 1000)
+        error = path + " has the version " + std::to_string(fileHeader.version) +
+            ", expected " + std::to_string(keyEventRecordingVersion) + ".";
+    else
+        return true;
+
+    close();
+    return false;
+}
+
+#ifdef _WIN32
+
+bool KeyEventRecordingFile::map(const std::string& path, std::string& error)
+{
+    // The recording can still be written by the program.
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        error = "cannot open " + path + " (error " + std::to_string(GetLastError()) + ").";
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(KeyEventRecordingHeader)))
+    {
+        error = path + " is not a key event recording.";
+        close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping != nullptr)
+        m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr)
+    {
+        error = "cannot map " + path + " (error " + std::to_string(GetLastError()) + ").";
+        close();
+        return false;
+    }
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    return true;
+}
+
+void KeyEventRecordingFile::close()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool KeyEventRecordingFile::map(const std::string& path, std::string& error)
+{
+    m_file = ::open(path.c_str(), O_RDONLY);
+    if (m_file < 0)
+    {
+        error = "cannot open " + path + ": " + std::strerror(errno) + ".";
+        return false;
+    }
+
+    struct stat fileStat = {};
+    if (::fstat(m_file, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(KeyEventRecordingHeader)))
+    {
+        error = path + " is not a key event recording.";
+        close();
+        return false;
+    }
+
+    void* data = ::mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        error = "cannot map " + path + ": " + std::strerror(errno) + ".";
+        close();
+        return false;
+    }
+    m_data = static_cast<const unsigned char*>(data);
+    m_size = static_cast<std::size_t>(fileStat.st_size);
+    return true;
+}
+
+void KeyEventRecordingFile::close()
+{
+    if (m_data != nullptr)
+        ::munmap(const_cast<unsigned char*>(m_data), m_size);
+    if (m_file >= 0)
+        ::close(m_file);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = -1;
+}
+
+#endif
+
+bool KeyEventRecordingFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+const KeyEventRecordingHeader& KeyEventRecordingFile::header() const
+{
+    return *reinterpret_cast<const KeyEventRecordingHeader*>(m_data);
+}
+
+KeyEventRecordingFile::Cursor KeyEventRecordingFile::records() const
+{
+    return Cursor(m_data + header().size, m_data + m_size);
+}
+
+bool KeyEventRecordingFile::isRecording(const std::string& path)
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    std::uint32_t magic = 0;
+    return file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) && magic == keyEventRecordingMagic;
+}
+
+bool readKeyEventRecording(const std::string& path, std::vector<KeyEvent>& events, std::string& error)
+{
+    KeyEventRecordingFile file;
+    if (!file.open(path, error))
+        return false;
+
+    // The releases sent by the program are not key events of the keyboard,
+    // the events injected by the other programs are seen by the program as such.
+    KeyEventRecordingFile::Cursor cursor = file.records();
+    KeyEventRecord record;
+    while (cursor.next(record))
+    {
+        if (record.isOwnRelease)
+            continue;
+        KeyEvent event = {};
+        event.time = record.time;
+        event.key = record.key;
+        event.isPressed = record.isPressed;
+        event.device = record.device;
+        events.push_back(event);
+    }
+    return true;
+}
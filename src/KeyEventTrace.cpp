@@ -0,0 +1,86 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "KeyEventTrace.h"
+
+#include <cstdlib>
+#include <sstream>
+
+bool readKeyEventTrace(std::istream& stream, std::vector<KeyEvent>& events, std::string& error)
+{
+    std::string line;
+    std::size_t lineNumber = 0;
+
+    while (std::getline(stream, line))
+    {
+        lineNumber++;
+
+        // Skip the empty lines and the comments.
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+
+        std::istringstream lineStream(line);
+        double time = 0.;
+        std::string keyText;
+        std::string stateText;
+        if (!(lineStream >> time >> keyText >> stateText))
+        {
+            error = "line " + std::to_string(lineNumber) + ": expected <time> <key> <down|up>.";
+            return false;
+        }
+
+        // The key is either in decimal or in hexadecimal with the 0x prefix.
+        char* end = nullptr;
+        unsigned long key = std::strtoul(keyText.c_str(), &end, 0);
+        if (end == keyText.c_str() || *end != '\0')
+        {
+            error = "line " + std::to_string(lineNumber) + ": invalid key \"" + keyText + "\".";
+            return false;
+        }
+
+        KeyEvent event = {};
+        event.time = chatterTimeFromMilliseconds(time);
+        event.key = key;
+        if (stateText == "down")
+            event.isPressed = true;
+        else if (stateText == "up")
+            event.isPressed = false;
+        else
+        {
+            error = "line " + std::to_string(lineNumber) + ": invalid state \"" + stateText + "\", expected down or up.";
+            return false;
+        }
+
+        // The device is optional, the default device otherwise.
+        std::string deviceText;
+        if (lineStream >> deviceText)
+        {
+            event.device = std::strtoull(deviceText.c_str(), &end, 0);
+            if (end == deviceText.c_str() || *end != '\0')
+            {
+                error = "line " + std::to_string(lineNumber) + ": invalid device \"" + deviceText + "\".";
+                return false;
+            }
+        }
+
+        events.push_back(event);
+    }
+
+    return true;
+}
@@ -17,6 +17,7 @@
 */
 
 #include "KeyPressData.h"
+#include "KeyboardHook.h"
 #include <iostream>
 #include <chrono>
 
@@ -25,14 +26,22 @@
 std::unique_ptr<KeyPressData> KeyPressData::_instance = nullptr;
 
 KeyPressData::KeyPressData() :
-    m_timeOfChatter(50000.),
+    m_localStatistics(),
 #ifdef NDEBUG
     m_isDebugEnabled(false),
 #else
     m_isDebugEnabled(true),
 #endif
-    m_timeSinceProgramStarted(std::chrono::system_clock::now())
-{}
+    m_hookWatchdog(m_clock, std::cout),
+    m_debugLog(std::cout),
+    m_releaseScheduler(m_engine, m_clock, *this),
+    m_hookEventFilter(m_releaseScheduler, m_hookWatchdog, m_debugLog, m_recorder, m_isDebugEnabled),
+    m_control(*this),
+    m_controlServer(m_control),
+    m_configWatcher(m_control, std::cout)
+{
+    m_releaseScheduler.setStatistics(&m_localStatistics);
+}
 
 KeyPressData::~KeyPressData()
 {
@@ -41,12 +50,15 @@ KeyPressData::~KeyPressData()
 
 void KeyPressData::waitForThreadToFinish()
 {
-    std::lock_guard<std::mutex>guard(m_threadReleaseKeysMutex);
-    for (int i = 0; i < m_threadReleaseKeys.size(); i++)
-    {
-        if (m_threadReleaseKeys.at(i).joinable())
-            m_threadReleaseKeys[i].join();
-    }
+    // Stop the threads of the hook watchdog, of the control endpoint and of the configuration
+    // watcher, the thread releasing the delayed keys, then the ones writing the debug messages
+    // and the recording.
+    m_hookWatchdog.stop();
+    m_controlServer.stop();
+    m_configWatcher.stop();
+    m_releaseScheduler.stop();
+    m_debugLog.stop();
+    m_recorder.close();
 }
 
 KeyPressData* KeyPressData::createInstance()
@@ -64,587 +76,188 @@ KeyPressData* KeyPressData::instance()
     return createInstance();
 }
 
-bool KeyPressData::isKeyPressChatter(unsigned long key)
+bool KeyPressData::isKeyChatter(unsigned long key, bool isPressed, bool isInjected, bool isOwnRelease,
+    std::chrono::steady_clock::time_point eventTime)
 {
-    /*
-    * Find if the key has already been pressed. If yes,
-    * check if the time passed since the last press is lower
-    * than the value of the variable m_timeOfChatter. If yes, 
-    * it's mean the key is a chatter and need to be rejected.
-    */
-    auto currentTime = std::chrono::system_clock::now();
-
-    int keyPos = findKeyPressPos(key);
-
-    std::chrono::duration<double, std::milli> timeSinceStartingOfTheProgram =
-        currentTime - m_timeSinceProgramStarted;
-
-    // If the key is not in the list, insert the key into it.
-    if (keyPos < 0)
-    {
-        KeyPressInfo keyInfo = {};
-        keyInfo.keyID = key;
-        keyInfo.timeWhenPressed = currentTime;
-        keyInfo.timeWhenPressedSinceTheStartingOfTheProgram = timeSinceStartingOfTheProgram;
-        appendKeyPressInfo(keyInfo);
-        return false;
-    }
+    // The time of the event is the one read by the hook, so the clock is read once per event.
+    const ChatterTime time = m_clock.toChatterTime(eventTime);
+    return m_hookEventFilter.filter(key, isPressed, isInjected, isOwnRelease, time) != ChatterDecision::Pass;
+}
 
-    std::chrono::duration<double, std::milli> timeSinceLastPress = 
-        currentTime - getKeyPressInfo(keyPos).timeWhenPressed;
-    std::chrono::duration<double, std::milli> lastPressTimeSinceStarting = getKeyPressInfo(keyPos).timeWhenPressedSinceTheStartingOfTheProgram;
-    
-    if (timeSinceLastPress < m_timeOfChatter)
-    {
-        // check if the key is a repeat key, if true, accept the key.
-        if (lastPressTimeSinceStarting > getKeyReleaseInfo(findKeyReleasePos(key)).timeWhenPressedSinceTheStartingOfTheProgram)
-            return false;
-        if (m_isDebugEnabled)
-            std::cout << "Chatter on " << keyName(key) << " key. Time since last press: " << timeSinceLastPress.count() << " ms." << std::endl;
-        setKeyPressTimeSinceStartingOfTheProgram(keyPos, timeSinceStartingOfTheProgram);
-        return true;
-    }
-    else
-    {
-        setKeyPressInfoTime(keyPos, currentTime);
-        setKeyPressTimeSinceStartingOfTheProgram(keyPos, timeSinceStartingOfTheProgram);
-        return false;
-    }
+void KeyPressData::releaseKey(unsigned long key)
+{
+    releaseKeys(&key, 1);
 }
 
-bool KeyPressData::isKeyReleaseChatter(unsigned long key)
+void KeyPressData::releaseKeys(const unsigned long* keys, std::size_t count)
 {
-    /*
-    * Find if the key has already been released. If yes,
-    * check if the time passed since the last release is lower
-    * than the value of the variable m_timeOfChatter. If yes, 
-    * it's mean the key is a chatter and need to be rejected.
-    */
-    auto currentTime = std::chrono::system_clock::now();
-
-    int keyPos = findKeyReleasePos(key);
-    int keyPressPos = findKeyPressPos(key);
-
-    // If no key has been released, releasing the key.
-    if (keyPos < 0)
+    // Called by the release scheduler when the delay of releases
+    // is elapsed, release the keys with one call to SendInput.
+    INPUT inputs[ChatterEngine::keyCount];
+    if (count > ChatterEngine::keyCount)
+        count = ChatterEngine::keyCount;
+    ZeroMemory(inputs, sizeof(INPUT) * count);
+    for (std::size_t i = 0; i < count; i++)
     {
-        KeyReleaseInfo keyInfo = {};
-        keyInfo.keyID = key;
-        keyInfo.timeWhenPressed = currentTime;
-        keyInfo.isKeyPressedSinceRelease = false;
-        appendKeyReleaseInfo(keyInfo);
-        keyPos = findKeyReleasePos(key);
+        inputs[i].type = INPUT_KEYBOARD;
+        inputs[i].ki.wVk = static_cast<WORD>(keys[i]);
+        inputs[i].ki.dwFlags = KEYEVENTF_KEYUP;
+        inputs[i].ki.dwExtraInfo = releaseTag;
     }
 
-    // Getting the time that happen since the start of the program.
-    std::chrono::duration<double, std::milli> timeSinceStartingOfTheProgram =
-        currentTime - m_timeSinceProgramStarted;
-    
-    setKeyReleaseTimeSinceStartingOfTheProgram(keyPos, timeSinceStartingOfTheProgram);
+    // The hook must see the releases, the watchdog probes it otherwise.
+    m_hookWatchdog.expectCallback();
 
-    // If the release of the key happen in a time since le press of the key less than m_timeOfChatter,
-    // then, delaying the key release.
-    if ((timeSinceStartingOfTheProgram - getKeyPressInfo(keyPressPos).timeWhenPressedSinceTheStartingOfTheProgram) < m_timeOfChatter)
-    {
-        std::lock_guard<std::mutex>guard(m_threadReleaseKeysMutex);
-        m_threadReleaseKeys.push_back(std::thread(&KeyPressData::waitBeforeReleasingKey, this, key, timeSinceStartingOfTheProgram));
-        return true;
-    }
-    else
+    // SendInput returns the number of events inserted, the other keys are not released.
+    unsigned int result = SendInput(static_cast<UINT>(count), inputs, sizeof(INPUT));
+    if (!m_isDebugEnabled)
+        return;
+    for (std::size_t i = result; i < count; i++)
     {
-        setKeyReleaseInfoTime(keyPos, currentTime);
-        setKeyReleaseIsKeyPressedSinceRelease(keyPos, false);
-        return false;
+        DebugRecord record = {};
+        record.time = m_clock.now();
+        record.key = keys[i];
+        record.type = DebugRecordType::ReleaseFailed;
+        record.decision = ChatterDecision::Delay;
+        m_debugLog.log(DebugLogSource::ReleaseScheduler, record);
     }
 }
 
-void KeyPressData::waitBeforeReleasingKey(unsigned long key, const std::chrono::duration<double, std::milli> timeWhenKeyRelease)
+HookLatency& KeyPressData::hookLatency()
 {
-    /*
-    * This function is used to delaying the release of a key.
-    * The reason is because of the chatter itself, when a key is chattering,
-    * the key is release but never repressed, so the user is pressing it but in the OS
-    * side, it's like the key is not pressed at all.
-    * This function delaying for a certain amont of time to check after the amont of time
-    * if the key need to be released.
-    */
-
-    // Waiting.
-	std::this_thread::sleep_for(m_timeOfChatter);
-
-    int keyPressPos = findKeyPressPos(key);
-    int keyReleasePos = findKeyReleasePos(key);
-
-    // If the time since the last release is higher than the actual release, it's mean that the key is already
-    // release, so, no need to release it again.
-    if (timeWhenKeyRelease < getKeyReleaseInfo(keyReleasePos).timeWhenPressedSinceTheStartingOfTheProgram)
-        return;
+    return m_hookLatency;
+}
 
-    // If the time since the last press is higher than the last press, it's mean that the user has released the key,
-    // so we releasing the key.
-    if (timeWhenKeyRelease > getKeyPressInfo(keyPressPos).timeWhenPressedSinceTheStartingOfTheProgram)
-    {
-        INPUT input[1];
-        ZeroMemory(input, sizeof(input));
-        input[0].type = INPUT_KEYBOARD;
-        input[0].ki.wVk = key;
-        input[0].ki.dwFlags = KEYEVENTF_KEYUP;
-
-        unsigned int result = SendInput(1, input, sizeof(INPUT));
-        if (m_isDebugEnabled)
-        {
-            if (result != 1)
-                std::cout << "Failed to release the " << keyName(key) << " key." << std::endl;
-        }
-    }
+HookWatchdog& KeyPressData::hookWatchdog()
+{
+    return m_hookWatchdog;
 }
 
-int KeyPressData::findKeyPressPos(unsigned long key) const
+KeyEventRecorder& KeyPressData::recorder()
 {
-    // Find if they is already a key in the vector m_keyPressInfo.
-    // If yes, return the position. If not, return -1.
-    std::lock_guard<std::mutex>guard(m_keyPressMutex);
-    for (int i = 0; i < m_keyPressInfo.size(); i++)
-    {
-        if (m_keyPressInfo.at(i).keyID == key)
-            return i;
-    }
+    return m_recorder;
+}
 
-    return -1;
+void KeyPressData::setChatterTime(double msec)
+{
+    // Setting the time of chatter, rounded to the microsecond.
+    setChatterTime(chatterTimeFromMilliseconds(msec));
 }
 
-int KeyPressData::findKeyReleasePos(unsigned long key) const
+void KeyPressData::setChatterTime(ChatterTime time)
 {
-    // Find if they is already a key in the vector m_keyReleaseInfo.
-    // If yes, return the position. If not, return -1.
-    std::lock_guard<std::mutex>guard(m_keyReleaseMutex);
-    for (int i = 0; i < m_keyReleaseInfo.size(); i++)
-    {
-        if (m_keyReleaseInfo.at(i).keyID == key)
-            return i;
-    }
+    if (time <= ChatterTime::zero())
+        return;
+    m_releaseScheduler.setChatterTime(time);
 
-    return -1;
+    // The releases are grouped by one millisecond, less for a small time of chatter.
+    const ChatterTime batchTime = time / 4;
+    m_releaseScheduler.setBatchTime(batchTime < std::chrono::milliseconds(1) ? batchTime : std::chrono::milliseconds(1));
 }
 
-const KeyPressData::KeyPressInfo KeyPressData::getKeyPressInfo(int pos) const
+void KeyPressData::setConfig(const ChatterConfig& config)
 {
-    if (pos < 0 || pos >= m_keyPressInfo.size()) 
-        return {};
-    std::lock_guard<std::mutex>guard(m_keyPressMutex);
-    return m_keyPressInfo.at(pos);
+    // Chatter times of each key and keys never filtered.
+    m_releaseScheduler.setConfig(config);
 }
 
-const KeyPressData::KeyReleaseInfo KeyPressData::getKeyReleaseInfo(int pos) const
+bool KeyPressData::loadConfig(const std::string& path, std::string& error)
 {
-    if (pos < 0 || pos >= m_keyReleaseInfo.size())
-        return {};
-    std::lock_guard<std::mutex>guard(m_keyReleaseMutex);
-    return m_keyReleaseInfo.at(pos);
+    // The configuration is read again each time it is written.
+    m_configPath = path;
+    return m_control.reloadConfig(error) && m_configWatcher.start(path, error);
 }
 
-void KeyPressData::appendKeyPressInfo(const KeyPressInfo& keyInfo)
+bool KeyPressData::openStatistics(const std::string& path, std::string& error)
 {
-    std::lock_guard<std::mutex>guard(m_keyPressMutex);
-    m_keyPressInfo.push_back(keyInfo);
+    // The counters of the engine are written into a memory mapped file,
+    // read by the monitoring tools without calling the program.
+    if (!m_statisticsFile.create(path, error))
+        return false;
+    m_releaseScheduler.setStatistics(m_statisticsFile.statistics());
+    return true;
 }
 
-void KeyPressData::appendKeyReleaseInfo(const KeyReleaseInfo& keyInfo)
+bool KeyPressData::startRecording(const std::string& path, std::string& error)
 {
-    std::lock_guard<std::mutex>guard(m_keyReleaseMutex);
-    m_keyReleaseInfo.push_back(keyInfo);
+    // Every event seen by the hook is recorded, with the decision of the engine.
+    return m_recorder.open(path, error);
 }
 
-void KeyPressData::setKeyPressInfoTime(int pos, std::chrono::time_point<std::chrono::system_clock> time)
+bool KeyPressData::enableAdaptiveChatterTime(double minimumMsec, double maximumMsec)
 {
-    if (pos < 0 || pos >= m_keyPressInfo.size())
-        return;
-    std::lock_guard<std::mutex>guard(m_keyPressMutex);
-    m_keyPressInfo[pos].timeWhenPressed = time;
+    // Each key learns its own time of chatter, between the bounds,
+    // if the policy of the engine can learn.
+    return m_releaseScheduler.enableAdaptiveChatterTime(
+        chatterTimeFromMilliseconds(minimumMsec), chatterTimeFromMilliseconds(maximumMsec));
 }
 
-void KeyPressData::setKeyReleaseInfoTime(int pos, std::chrono::time_point<std::chrono::system_clock> time)
+void KeyPressData::enableDebug(bool value)
 {
-    if (pos < 0 || pos >= m_keyReleaseInfo.size())
-        return;
-    std::lock_guard<std::mutex>guard(m_keyReleaseMutex);
-    m_keyReleaseInfo[pos].timeWhenPressed = time;
+    m_isDebugEnabled = value;
 }
 
-void KeyPressData::setChatterTime(int msec)
+bool KeyPressData::startControl(const std::string& name, std::string& error)
 {
-    // Setting the time of chatter.
-    if (msec <= 0)
-        return;
-    m_timeOfChatter = std::chrono::duration<double, std::micro>(double(msec) * 1000);
+    return m_controlServer.start(name, error);
 }
 
-void KeyPressData::enableDebug(bool value)
+KeyPressData::Control::Control(KeyPressData& keyPressData) :
+    m_keyPressData(keyPressData)
+{}
+
+const ChatterStatistics* KeyPressData::Control::statistics() const
 {
-    m_isDebugEnabled = value;
+    if (m_keyPressData.m_statisticsFile.isOpen())
+        return m_keyPressData.m_statisticsFile.statistics();
+    return &m_keyPressData.m_localStatistics;
 }
 
-void KeyPressData::setKeyReleaseIsKeyPressedSinceRelease(int pos, bool value)
+const HookLatency* KeyPressData::Control::hookLatency() const
 {
-    if (pos < 0 || pos >= m_keyReleaseInfo.size())
-        return;
-    std::lock_guard<std::mutex>guard(m_keyReleaseMutex);
-    m_keyReleaseInfo[pos].isKeyPressedSinceRelease = value;
+    return &m_keyPressData.m_hookLatency;
 }
 
-void KeyPressData::setKeyPressTimeSinceStartingOfTheProgram(int pos, const std::chrono::duration<double, std::milli>& time)
+const HookWatchdog* KeyPressData::Control::hookWatchdog() const
 {
-    if (pos < 0 || pos >= m_keyPressInfo.size())
-        return;
-    std::lock_guard<std::mutex>guard(m_keyPressMutex);
-    m_keyPressInfo[pos].timeWhenPressedSinceTheStartingOfTheProgram = time;
+    return &m_keyPressData.m_hookWatchdog;
 }
 
-void KeyPressData::setKeyReleaseTimeSinceStartingOfTheProgram(int pos, const std::chrono::duration<double, std::milli>& time)
+ChatterTime KeyPressData::Control::chatterTime() const
 {
-    if (pos < 0 || pos >= m_keyReleaseInfo.size())
-        return;
-    std::lock_guard<std::mutex>guard(m_keyReleaseMutex);
-    m_keyReleaseInfo[pos].timeWhenPressedSinceTheStartingOfTheProgram = time;
+    return m_keyPressData.m_releaseScheduler.chatterTime();
 }
 
-void KeyPressData::removingFinishedThread()
+void KeyPressData::Control::setChatterTime(ChatterTime time)
 {
-    // Removing all the finished thread inside m_threadReleaseKeys.
-    std::lock_guard<std::mutex>guard(m_threadReleaseKeysMutex);
-    for (int i = m_threadReleaseKeys.size() - 1; i >= 0; i--)
-    {
-        if (!m_threadReleaseKeys.at(i).joinable())
-            m_threadReleaseKeys.erase(m_threadReleaseKeys.cbegin()+i);
-    }
+    m_keyPressData.setChatterTime(time);
 }
 
-std::string KeyPressData::keyName(unsigned long keyNumber)
+bool KeyPressData::Control::reloadConfig(std::string& error)
 {
-    // Base on the windows documentation : https://docs.microsoft.com/en-us/windows/win32/inputdev/virtual-key-codes
-    // Return the name of a key.
-    switch(keyNumber)
+    // The time of chatter is the default one of the configuration. The engine
+    // publishes the new chatter times without stopping the hook.
+    if (m_keyPressData.m_configPath.empty())
     {
-    case VK_BACK:
-        return "backspace";
-    case VK_TAB:
-        return "tab";
-    case VK_CLEAR:
-        return "clear";
-    case VK_RETURN:
-        return "enter";
-    case VK_SHIFT:
-        return "shift";
-    case VK_CONTROL:
-        return "control";
-    case VK_MENU:
-        return "alt";
-    case VK_PAUSE:
-        return "pause";
-    case VK_CAPITAL:
-        return "caps lock";
-    case VK_KANA:
-        return "ime kana";
-    case VK_ESCAPE:
-        return "escape";
-    case VK_SPACE:
-        return "spacebar";
-    case VK_PRIOR:
-        return "page up";
-    case VK_NEXT:
-        return "page down";
-    case VK_END:
-        return "end";
-    case VK_HOME:
-        return "home";
-    case VK_LEFT:
-        return "left arrow";
-    case VK_UP:
-        return "up arrow";
-    case VK_RIGHT:
-        return "right arrow";
-    case VK_DOWN:
-        return "down arrow";
-    case VK_SELECT:
-        return "select";
-    case VK_PRINT:
-        return "print";
-    case VK_EXECUTE:
-        return "execute";
-    case VK_SNAPSHOT:
-        return "print screen";
-    case VK_INSERT:
-        return "insert";
-    case VK_DELETE:
-        return "delete";
-    case VK_HELP:
-        return "HELP";
-    case 0x30:
-        return "0";
-    case 0x31:
-        return "1";
-    case 0x32:
-        return "2";
-    case 0x33:
-        return "3";
-    case 0x34:
-        return "4";
-    case 0x35:
-        return "5";
-    case 0x36:
-        return "6";
-    case 0x37:
-        return "7";
-    case 0x38:
-        return "8";
-    case 0x39:
-        return "9";
-    case 0x41:
-        return "A";
-    case 0x42:
-        return "B";
-    case 0x43:
-        return "C";
-    case 0x44:
-        return "D";
-    case 0x45:
-        return "E";
-    case 0x46:
-        return "F";
-    case 0x47:
-        return "G";
-    case 0x48:
-        return "H";
-    case 0x49:
-        return "I";
-    case 0x4A:
-        return "J";
-    case 0x4B:
-        return "K";
-    case 0x4C:
-        return "L";
-    case 0x4D:
-        return "M";
-    case 0x4E:
-        return "N";
-    case 0x4F:
-        return "O";
-    case 0x50:
-        return "P";
-    case 0x51:
-        return "Q";
-    case 0x52:
-        return "R";
-    case 0x53:
-        return "S";
-    case 0x54:
-        return "T";
-    case 0x55:
-        return "U";
-    case 0x56:
-        return "V";
-    case 0x57:
-        return "W";
-    case 0x58:
-        return "X";
-    case 0x59:
-        return "Y";
-    case 0x5A:
-        return "Z";
-    case VK_LWIN:
-        return "left windows";
-    case VK_RWIN:
-        return "right windows";
-    case VK_APPS:
-        return "application";
-    case VK_SLEEP:
-        return "computer sleep";
-    case VK_NUMPAD0:
-        return "numpad 0";
-    case VK_NUMPAD1:
-        return "numpad 1";
-    case VK_NUMPAD2:
-        return "numpad 2";
-    case VK_NUMPAD3:
-        return "numpad 3";
-    case VK_NUMPAD4:
-        return "numpad 4";
-    case VK_NUMPAD5:
-        return "numpad 5";
-    case VK_NUMPAD6:
-        return "numpad 6";
-    case VK_NUMPAD7:
-        return "numpad 7";
-    case VK_NUMPAD8:
-        return "numpad 8";
-    case VK_NUMPAD9:
-        return "numpad 9";
-    case VK_MULTIPLY:
-        return "muliply";
-    case VK_ADD:
-        return "add";
-    case VK_SEPARATOR:
-        return "separator";
-    case VK_SUBTRACT:
-        return "subtract";
-    case VK_DECIMAL:
-        return "decimal";
-    case VK_DIVIDE:
-        return "devide";
-    case VK_F1:
-        return "F1";
-    case VK_F2:
-        return "F2";
-    case VK_F3:
-        return "F3";
-    case VK_F4:
-        return "F4";
-    case VK_F5:
-        return "F5";
-    case VK_F6:
-        return "F6";
-    case VK_F7:
-        return "F7";
-    case VK_F8:
-        return "F8";
-    case VK_F9:
-        return "F9";
-    case VK_F10:
-        return "F10";
-    case VK_F11:
-        return "F11";
-    case VK_F12:
-        return "F12";
-    case VK_F13:
-        return "F13";
-    case VK_F14:
-        return "F14";
-    case VK_F15:
-        return "F15";
-    case VK_F16:
-        return "F16";
-    case VK_F17:
-        return "F17";
-    case VK_F18:
-        return "F18";
-    case VK_F19:
-        return "F19";
-    case VK_F20:
-        return "F20";
-    case VK_F21:
-        return "F21";
-    case VK_F22:
-        return "F22";
-    case VK_F23:
-        return "F23";
-    case VK_F24:
-        return "F24";
-    case VK_NUMLOCK:
-        return "num lock";
-    case VK_SCROLL:
-        return "scroll lock";
-    case VK_LSHIFT:
-        return "left shift";
-    case VK_RSHIFT:
-        return "right shift";
-    case VK_LCONTROL:
-        return "left control";
-    case VK_RCONTROL:
-        return "right control";
-    case VK_LMENU:
-        return "left menu";
-    case VK_RMENU:
-        return "right menu";
-    case VK_BROWSER_BACK:
-        return "browser back";
-    case VK_BROWSER_FORWARD:
-        return "browser forward";
-    case VK_BROWSER_REFRESH:
-        return "browser refresh";
-    case VK_BROWSER_STOP:
-        return "browser stop";
-    case VK_BROWSER_SEARCH:
-        return "browser search";
-    case VK_BROWSER_FAVORITES:
-        return "browser favorites";
-    case VK_BROWSER_HOME:
-        return "browser home";
-    case VK_VOLUME_MUTE:    
-        return "volume mute";
-    case VK_VOLUME_UP:  
-        return "volume up";
-    case VK_VOLUME_DOWN:
-        return "volume down";
-    case VK_MEDIA_NEXT_TRACK:
-        return "media next track";
-    case VK_MEDIA_PREV_TRACK:
-        return "media previous track";
-    case VK_MEDIA_STOP:
-        return "media stop";
-    case VK_MEDIA_PLAY_PAUSE:
-        return "media play/pause";
-    case VK_LAUNCH_MAIL:
-        return "launch mail";
-    case VK_LAUNCH_APP1:
-        return "launch app1";
-    case VK_LAUNCH_APP2:
-        return "launch app2";
-    case VK_OEM_1:
-        return ";: us layout";
-    case VK_OEM_PLUS:
-        return "+";
-    case VK_OEM_COMMA:
-        return ",";
-    case VK_OEM_MINUS:
-        return "-";
-    case VK_OEM_PERIOD:
-        return ".";
-    case VK_OEM_2:
-        return "/? us layout";
-    case VK_OEM_3:
-        return "~ us layout";
-    case VK_OEM_4:
-        return "[{ us layout";
-    case VK_OEM_5:
-        return "\\| us layout";
-    case VK_OEM_6:
-        return "]} us layout";
-    case VK_OEM_7:
-        return "single-quote/double quote us layout";
-    case VK_PROCESSKEY:
-        return "ime process";
-    case VK_ATTN:
-        return "attention interrupt";
-    case VK_CRSEL:
-        return "crsel";
-    case VK_EXSEL:
-        return "exsel";
-    case VK_EREOF:
-        return "erase eof";
-    case VK_PLAY:
-        return "play";
-    case VK_ZOOM:
-        return "zoom";
-    case VK_PA1:
-        return "pa1";
-    case VK_OEM_CLEAR:
-        return "clear";
-    case VK_JUNJA:
-        return "ime junja mode";
-    case VK_FINAL:
-        return "ime final mode";
-    case VK_HANJA:
-        return "ime hanja mode";
-    case 0x1A:
-        return "ime off";
-    case VK_CONVERT:
-        return "ime convert";
-    case VK_NONCONVERT:
-        return "ime nonconvert";
-    case VK_ACCEPT:
-        return "ime accept";
-    case VK_MODECHANGE:
-        return "ime mode change request";
+        error = "no configuration file, see --config.";
+        return false;
     }
-    return "unknow";
-}
\ No newline at end of file
+
+    ChatterConfig config;
+    config.setDefaultChatterTime(m_keyPressData.m_releaseScheduler.chatterTime());
+    if (!config.readFile(m_keyPressData.m_configPath, error))
+        return false;
+    m_keyPressData.setConfig(config);
+    return true;
+}
+
+bool KeyPressData::Control::isDebugEnabled() const
+{
+    return m_keyPressData.m_isDebugEnabled;
+}
+
+bool KeyPressData::Control::enableDebug(bool enable)
+{
+    m_keyPressData.enableDebug(enable);
+    return true;
+}
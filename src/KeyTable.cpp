@@ -0,0 +1,396 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "KeyTable.h"
+#include <cstdlib>
+#include <cctype>
+
+namespace
+{
+    // Base on the windows documentation : https://docs.microsoft.com/en-us/windows/win32/inputdev/virtual-key-codes
+    // One entry for each virtual key code, indexed by the code.
+    constexpr KeyDescription keyTable[keyTableSize] =
+    {
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x00
+        { "left mouse button", KeyCategory::Mouse, KeyFlagNone }, // 0x01 VK_LBUTTON
+        { "right mouse button", KeyCategory::Mouse, KeyFlagNone }, // 0x02 VK_RBUTTON
+        { "control-break", KeyCategory::System, KeyFlagNone }, // 0x03 VK_CANCEL
+        { "middle mouse button", KeyCategory::Mouse, KeyFlagNone }, // 0x04 VK_MBUTTON
+        { "x1 mouse button", KeyCategory::Mouse, KeyFlagNone }, // 0x05 VK_XBUTTON1
+        { "x2 mouse button", KeyCategory::Mouse, KeyFlagNone }, // 0x06 VK_XBUTTON2
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x07
+        { "backspace", KeyCategory::Editing, KeyFlagNone }, // 0x08 VK_BACK
+        { "tab", KeyCategory::Control, KeyFlagNone }, // 0x09 VK_TAB
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x0A
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x0B
+        { "clear", KeyCategory::Editing, KeyFlagNone }, // 0x0C VK_CLEAR
+        { "enter", KeyCategory::Control, KeyFlagNone }, // 0x0D VK_RETURN
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x0E
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x0F
+        { "shift", KeyCategory::Modifier, KeyFlagGeneric }, // 0x10 VK_SHIFT
+        { "control", KeyCategory::Modifier, KeyFlagGeneric }, // 0x11 VK_CONTROL
+        { "alt", KeyCategory::Modifier, KeyFlagGeneric }, // 0x12 VK_MENU
+        { "pause", KeyCategory::System, KeyFlagNone }, // 0x13 VK_PAUSE
+        { "caps lock", KeyCategory::Lock, KeyFlagToggle }, // 0x14 VK_CAPITAL
+        { "ime kana", KeyCategory::Ime, KeyFlagNone }, // 0x15 VK_KANA
+        { "ime on", KeyCategory::Ime, KeyFlagNone }, // 0x16 VK_IME_ON
+        { "ime junja mode", KeyCategory::Ime, KeyFlagNone }, // 0x17 VK_JUNJA
+        { "ime final mode", KeyCategory::Ime, KeyFlagNone }, // 0x18 VK_FINAL
+        { "ime hanja mode", KeyCategory::Ime, KeyFlagNone }, // 0x19 VK_HANJA
+        { "ime off", KeyCategory::Ime, KeyFlagNone }, // 0x1A VK_IME_OFF
+        { "escape", KeyCategory::Control, KeyFlagNone }, // 0x1B VK_ESCAPE
+        { "ime convert", KeyCategory::Ime, KeyFlagNone }, // 0x1C VK_CONVERT
+        { "ime nonconvert", KeyCategory::Ime, KeyFlagNone }, // 0x1D VK_NONCONVERT
+        { "ime accept", KeyCategory::Ime, KeyFlagNone }, // 0x1E VK_ACCEPT
+        { "ime mode change request", KeyCategory::Ime, KeyFlagNone }, // 0x1F VK_MODECHANGE
+        { "spacebar", KeyCategory::Control, KeyFlagPrintable }, // 0x20 VK_SPACE
+        { "page up", KeyCategory::Navigation, KeyFlagNone }, // 0x21 VK_PRIOR
+        { "page down", KeyCategory::Navigation, KeyFlagNone }, // 0x22 VK_NEXT
+        { "end", KeyCategory::Navigation, KeyFlagNone }, // 0x23 VK_END
+        { "home", KeyCategory::Navigation, KeyFlagNone }, // 0x24 VK_HOME
+        { "left arrow", KeyCategory::Navigation, KeyFlagNone }, // 0x25 VK_LEFT
+        { "up arrow", KeyCategory::Navigation, KeyFlagNone }, // 0x26 VK_UP
+        { "right arrow", KeyCategory::Navigation, KeyFlagNone }, // 0x27 VK_RIGHT
+        { "down arrow", KeyCategory::Navigation, KeyFlagNone }, // 0x28 VK_DOWN
+        { "select", KeyCategory::System, KeyFlagNone }, // 0x29 VK_SELECT
+        { "print", KeyCategory::System, KeyFlagNone }, // 0x2A VK_PRINT
+        { "execute", KeyCategory::System, KeyFlagNone }, // 0x2B VK_EXECUTE
+        { "print screen", KeyCategory::System, KeyFlagNone }, // 0x2C VK_SNAPSHOT
+        { "insert", KeyCategory::Editing, KeyFlagNone }, // 0x2D VK_INSERT
+        { "delete", KeyCategory::Editing, KeyFlagNone }, // 0x2E VK_DELETE
+        { "HELP", KeyCategory::System, KeyFlagNone }, // 0x2F VK_HELP
+        { "0", KeyCategory::Digit, KeyFlagPrintable }, // 0x30 '0'
+        { "1", KeyCategory::Digit, KeyFlagPrintable }, // 0x31 '1'
+        { "2", KeyCategory::Digit, KeyFlagPrintable }, // 0x32 '2'
+        { "3", KeyCategory::Digit, KeyFlagPrintable }, // 0x33 '3'
+        { "4", KeyCategory::Digit, KeyFlagPrintable }, // 0x34 '4'
+        { "5", KeyCategory::Digit, KeyFlagPrintable }, // 0x35 '5'
+        { "6", KeyCategory::Digit, KeyFlagPrintable }, // 0x36 '6'
+        { "7", KeyCategory::Digit, KeyFlagPrintable }, // 0x37 '7'
+        { "8", KeyCategory::Digit, KeyFlagPrintable }, // 0x38 '8'
+        { "9", KeyCategory::Digit, KeyFlagPrintable }, // 0x39 '9'
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x3A
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x3B
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x3C
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x3D
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x3E
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x3F
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x40
+        { "A", KeyCategory::Alpha, KeyFlagPrintable }, // 0x41 'A'
+        { "B", KeyCategory::Alpha, KeyFlagPrintable }, // 0x42 'B'
+        { "C", KeyCategory::Alpha, KeyFlagPrintable }, // 0x43 'C'
+        { "D", KeyCategory::Alpha, KeyFlagPrintable }, // 0x44 'D'
+        { "E", KeyCategory::Alpha, KeyFlagPrintable }, // 0x45 'E'
+        { "F", KeyCategory::Alpha, KeyFlagPrintable }, // 0x46 'F'
+        { "G", KeyCategory::Alpha, KeyFlagPrintable }, // 0x47 'G'
+        { "H", KeyCategory::Alpha, KeyFlagPrintable }, // 0x48 'H'
+        { "I", KeyCategory::Alpha, KeyFlagPrintable }, // 0x49 'I'
+        { "J", KeyCategory::Alpha, KeyFlagPrintable }, // 0x4A 'J'
+        { "K", KeyCategory::Alpha, KeyFlagPrintable }, // 0x4B 'K'
+        { "L", KeyCategory::Alpha, KeyFlagPrintable }, // 0x4C 'L'
+        { "M", KeyCategory::Alpha, KeyFlagPrintable }, // 0x4D 'M'
+        { "N", KeyCategory::Alpha, KeyFlagPrintable }, // 0x4E 'N'
+        { "O", KeyCategory::Alpha, KeyFlagPrintable }, // 0x4F 'O'
+        { "P", KeyCategory::Alpha, KeyFlagPrintable }, // 0x50 'P'
+        { "Q", KeyCategory::Alpha, KeyFlagPrintable }, // 0x51 'Q'
+        { "R", KeyCategory::Alpha, KeyFlagPrintable }, // 0x52 'R'
+        { "S", KeyCategory::Alpha, KeyFlagPrintable }, // 0x53 'S'
+        { "T", KeyCategory::Alpha, KeyFlagPrintable }, // 0x54 'T'
+        { "U", KeyCategory::Alpha, KeyFlagPrintable }, // 0x55 'U'
+        { "V", KeyCategory::Alpha, KeyFlagPrintable }, // 0x56 'V'
+        { "W", KeyCategory::Alpha, KeyFlagPrintable }, // 0x57 'W'
+        { "X", KeyCategory::Alpha, KeyFlagPrintable }, // 0x58 'X'
+        { "Y", KeyCategory::Alpha, KeyFlagPrintable }, // 0x59 'Y'
+        { "Z", KeyCategory::Alpha, KeyFlagPrintable }, // 0x5A 'Z'
+        { "left windows", KeyCategory::Modifier, KeyFlagSided }, // 0x5B VK_LWIN
+        { "right windows", KeyCategory::Modifier, KeyFlagSided }, // 0x5C VK_RWIN
+        { "application", KeyCategory::System, KeyFlagNone }, // 0x5D VK_APPS
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x5E
+        { "computer sleep", KeyCategory::System, KeyFlagNone }, // 0x5F VK_SLEEP
+        { "numpad 0", KeyCategory::Numpad, KeyFlagPrintable }, // 0x60 VK_NUMPAD0
+        { "numpad 1", KeyCategory::Numpad, KeyFlagPrintable }, // 0x61 VK_NUMPAD1
+        { "numpad 2", KeyCategory::Numpad, KeyFlagPrintable }, // 0x62 VK_NUMPAD2
+        { "numpad 3", KeyCategory::Numpad, KeyFlagPrintable }, // 0x63 VK_NUMPAD3
+        { "numpad 4", KeyCategory::Numpad, KeyFlagPrintable }, // 0x64 VK_NUMPAD4
+        { "numpad 5", KeyCategory::Numpad, KeyFlagPrintable }, // 0x65 VK_NUMPAD5
+        { "numpad 6", KeyCategory::Numpad, KeyFlagPrintable }, // 0x66 VK_NUMPAD6
+        { "numpad 7", KeyCategory::Numpad, KeyFlagPrintable }, // 0x67 VK_NUMPAD7
+        { "numpad 8", KeyCategory::Numpad, KeyFlagPrintable }, // 0x68 VK_NUMPAD8
+        { "numpad 9", KeyCategory::Numpad, KeyFlagPrintable }, // 0x69 VK_NUMPAD9
+        { "muliply", KeyCategory::Numpad, KeyFlagPrintable }, // 0x6A VK_MULTIPLY
+        { "add", KeyCategory::Numpad, KeyFlagPrintable }, // 0x6B VK_ADD
+        { "separator", KeyCategory::Numpad, KeyFlagNone }, // 0x6C VK_SEPARATOR
+        { "subtract", KeyCategory::Numpad, KeyFlagPrintable }, // 0x6D VK_SUBTRACT
+        { "decimal", KeyCategory::Numpad, KeyFlagPrintable }, // 0x6E VK_DECIMAL
+        { "devide", KeyCategory::Numpad, KeyFlagPrintable }, // 0x6F VK_DIVIDE
+        { "F1", KeyCategory::Function, KeyFlagNone }, // 0x70 VK_F1
+        { "F2", KeyCategory::Function, KeyFlagNone }, // 0x71 VK_F2
+        { "F3", KeyCategory::Function, KeyFlagNone }, // 0x72 VK_F3
+        { "F4", KeyCategory::Function, KeyFlagNone }, // 0x73 VK_F4
+        { "F5", KeyCategory::Function, KeyFlagNone }, // 0x74 VK_F5
+        { "F6", KeyCategory::Function, KeyFlagNone }, // 0x75 VK_F6
+        { "F7", KeyCategory::Function, KeyFlagNone }, // 0x76 VK_F7
+        { "F8", KeyCategory::Function, KeyFlagNone }, // 0x77 VK_F8
+        { "F9", KeyCategory::Function, KeyFlagNone }, // 0x78 VK_F9
+        { "F10", KeyCategory::Function, KeyFlagNone }, // 0x79 VK_F10
+        { "F11", KeyCategory::Function, KeyFlagNone }, // 0x7A VK_F11
+        { "F12", KeyCategory::Function, KeyFlagNone }, // 0x7B VK_F12
+        { "F13", KeyCategory::Function, KeyFlagNone }, // 0x7C VK_F13
+        { "F14", KeyCategory::Function, KeyFlagNone }, // 0x7D VK_F14
+        { "F15", KeyCategory::Function, KeyFlagNone }, // 0x7E VK_F15
+        { "F16", KeyCategory::Function, KeyFlagNone }, // 0x7F VK_F16
+        { "F17", KeyCategory::Function, KeyFlagNone }, // 0x80 VK_F17
+        { "F18", KeyCategory::Function, KeyFlagNone }, // 0x81 VK_F18
+        { "F19", KeyCategory::Function, KeyFlagNone }, // 0x82 VK_F19
+        { "F20", KeyCategory::Function, KeyFlagNone }, // 0x83 VK_F20
+        { "F21", KeyCategory::Function, KeyFlagNone }, // 0x84 VK_F21
+        { "F22", KeyCategory::Function, KeyFlagNone }, // 0x85 VK_F22
+        { "F23", KeyCategory::Function, KeyFlagNone }, // 0x86 VK_F23
+        { "F24", KeyCategory::Function, KeyFlagNone }, // 0x87 VK_F24
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x88
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x89
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x8A
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x8B
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x8C
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x8D
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x8E
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x8F
+        { "num lock", KeyCategory::Lock, KeyFlagToggle }, // 0x90 VK_NUMLOCK
+        { "scroll lock", KeyCategory::Lock, KeyFlagToggle }, // 0x91 VK_SCROLL
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x92
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x93
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x94
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x95
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x96
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x97
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x98
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x99
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x9A
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x9B
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x9C
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x9D
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x9E
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0x9F
+        { "left shift", KeyCategory::Modifier, KeyFlagSided }, // 0xA0 VK_LSHIFT
+        { "right shift", KeyCategory::Modifier, KeyFlagSided }, // 0xA1 VK_RSHIFT
+        { "left control", KeyCategory::Modifier, KeyFlagSided }, // 0xA2 VK_LCONTROL
+        { "right control", KeyCategory::Modifier, KeyFlagSided }, // 0xA3 VK_RCONTROL
+        { "left menu", KeyCategory::Modifier, KeyFlagSided }, // 0xA4 VK_LMENU
+        { "right menu", KeyCategory::Modifier, KeyFlagSided }, // 0xA5 VK_RMENU
+        { "browser back", KeyCategory::Media, KeyFlagNone }, // 0xA6 VK_BROWSER_BACK
+        { "browser forward", KeyCategory::Media, KeyFlagNone }, // 0xA7 VK_BROWSER_FORWARD
+        { "browser refresh", KeyCategory::Media, KeyFlagNone }, // 0xA8 VK_BROWSER_REFRESH
+        { "browser stop", KeyCategory::Media, KeyFlagNone }, // 0xA9 VK_BROWSER_STOP
+        { "browser search", KeyCategory::Media, KeyFlagNone }, // 0xAA VK_BROWSER_SEARCH
+        { "browser favorites", KeyCategory::Media, KeyFlagNone }, // 0xAB VK_BROWSER_FAVORITES
+        { "browser home", KeyCategory::Media, KeyFlagNone }, // 0xAC VK_BROWSER_HOME
+        { "volume mute", KeyCategory::Media, KeyFlagNone }, // 0xAD VK_VOLUME_MUTE
+        { "volume down", KeyCategory::Media, KeyFlagNone }, // 0xAE VK_VOLUME_DOWN
+        { "volume up", KeyCategory::Media, KeyFlagNone }, // 0xAF VK_VOLUME_UP
+        { "media next track", KeyCategory::Media, KeyFlagNone }, // 0xB0 VK_MEDIA_NEXT_TRACK
+        { "media previous track", KeyCategory::Media, KeyFlagNone }, // 0xB1 VK_MEDIA_PREV_TRACK
+        { "media stop", KeyCategory::Media, KeyFlagNone }, // 0xB2 VK_MEDIA_STOP
+        { "media play/pause", KeyCategory::Media, KeyFlagNone }, // 0xB3 VK_MEDIA_PLAY_PAUSE
+        { "launch mail", KeyCategory::Media, KeyFlagNone }, // 0xB4 VK_LAUNCH_MAIL
+        { "launch media select", KeyCategory::Media, KeyFlagNone }, // 0xB5 VK_LAUNCH_MEDIA_SELECT
+        { "launch app1", KeyCategory::Media, KeyFlagNone }, // 0xB6 VK_LAUNCH_APP1
+        { "launch app2", KeyCategory::Media, KeyFlagNone }, // 0xB7 VK_LAUNCH_APP2
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xB8
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xB9
+        { ";: us layout", KeyCategory::Oem, KeyFlagPrintable }, // 0xBA VK_OEM_1
+        { "+", KeyCategory::Oem, KeyFlagPrintable }, // 0xBB VK_OEM_PLUS
+        { ",", KeyCategory::Oem, KeyFlagPrintable }, // 0xBC VK_OEM_COMMA
+        { "-", KeyCategory::Oem, KeyFlagPrintable }, // 0xBD VK_OEM_MINUS
+        { ".", KeyCategory::Oem, KeyFlagPrintable }, // 0xBE VK_OEM_PERIOD
+        { "/? us layout", KeyCategory::Oem, KeyFlagPrintable }, // 0xBF VK_OEM_2
+        { "~ us layout", KeyCategory::Oem, KeyFlagPrintable }, // 0xC0 VK_OEM_3
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xC1
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xC2
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xC3
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xC4
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xC5
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xC6
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xC7
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xC8
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xC9
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xCA
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xCB
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xCC
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xCD
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xCE
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xCF
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD0
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD1
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD2
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD3
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD4
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD5
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD6
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD7
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD8
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xD9
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xDA
+        { "[{ us layout", KeyCategory::Oem, KeyFlagPrintable }, // 0xDB VK_OEM_4
+        { "\\| us layout", KeyCategory::Oem, KeyFlagPrintable }, // 0xDC VK_OEM_5
+        { "]} us layout", KeyCategory::Oem, KeyFlagPrintable }, // 0xDD VK_OEM_6
+        { "single-quote/double quote us layout", KeyCategory::Oem, KeyFlagPrintable }, // 0xDE VK_OEM_7
+        { "oem 8", KeyCategory::Oem, KeyFlagPrintable }, // 0xDF VK_OEM_8
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xE0
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xE1
+        { "<> or \\| non us layout", KeyCategory::Oem, KeyFlagPrintable }, // 0xE2 VK_OEM_102
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xE3
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xE4
+        { "ime process", KeyCategory::Ime, KeyFlagNone }, // 0xE5 VK_PROCESSKEY
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xE6
+        { "packet", KeyCategory::System, KeyFlagNone }, // 0xE7 VK_PACKET
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xE8
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xE9
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xEA
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xEB
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xEC
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xED
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xEE
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xEF
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xF0
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xF1
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xF2
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xF3
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xF4
+        { "unknown", KeyCategory::Unknown, KeyFlagNone }, // 0xF5
+        { "attention interrupt", KeyCategory::System, KeyFlagNone }, // 0xF6 VK_ATTN
+        { "crsel", KeyCategory::System, KeyFlagNone }, // 0xF7 VK_CRSEL
+        { "exsel", KeyCategory::System, KeyFlagNone }, // 0xF8 VK_EXSEL
+        { "erase eof", KeyCategory::System, KeyFlagNone }, // 0xF9 VK_EREOF
+        { "play", KeyCategory::Media, KeyFlagNone }, // 0xFA VK_PLAY
+        { "zoom", KeyCategory::Media, KeyFlagNone }, // 0xFB VK_ZOOM
+        { "noname", KeyCategory::System, KeyFlagNone }, // 0xFC VK_NONAME
+        { "pa1", KeyCategory::System, KeyFlagNone }, // 0xFD VK_PA1
+        { "oem clear", KeyCategory::System, KeyFlagNone }, // 0xFE VK_OEM_CLEAR
+        { "unknown", KeyCategory::Unknown, KeyFlagNone } // 0xFF
+    };
+
+    static_assert(sizeof(keyTable) / sizeof(keyTable[0]) == keyTableSize,
+        "The key table must have one entry for each virtual key code.");
+    static_assert(keyTable[0x41].category == KeyCategory::Alpha,
+        "The key table is not indexed by the virtual key code.");
+
+    const KeyDescription unknownKey = { "unknown", KeyCategory::Unknown, KeyFlagNone };
+
+    const char* const categoryNames[] =
+    {
+        "unknown",
+        "mouse",
+        "modifier",
+        "lock",
+        "control",
+        "navigation",
+        "editing",
+        "alpha",
+        "digit",
+        "function",
+        "numpad",
+        "oem",
+        "media",
+        "ime",
+        "system"
+    };
+
+    static_assert(sizeof(categoryNames) / sizeof(categoryNames[0]) == keyCategoryCount,
+        "Every key category must have a name.");
+
+    bool isSameName(const char* a, const char* b)
+    {
+        for (; *a && *b; a++, b++)
+        {
+            if (std::tolower(static_cast<unsigned char>(*a)) != std::tolower(static_cast<unsigned char>(*b)))
+                return false;
+        }
+        return *a == *b;
+    }
+}
+
+const KeyDescription& keyDescription(unsigned long keyNumber)
+{
+    if (keyNumber >= keyTableSize)
+        return unknownKey;
+    return keyTable[keyNumber];
+}
+
+const char* keyName(unsigned long keyNumber)
+{
+    return keyDescription(keyNumber).name;
+}
+
+KeyCategory keyCategory(unsigned long keyNumber)
+{
+    return keyDescription(keyNumber).category;
+}
+
+std::uint8_t keyFlags(unsigned long keyNumber)
+{
+    return keyDescription(keyNumber).flags;
+}
+
+bool keyFromName(const char* name, unsigned long& keyNumber)
+{
+    if (!name || !*name)
+        return false;
+
+    for (std::size_t i = 0; i < keyTableSize; i++)
+    {
+        if (keyTable[i].category != KeyCategory::Unknown && isSameName(keyTable[i].name, name))
+        {
+            keyNumber = static_cast<unsigned long>(i);
+            return true;
+        }
+    }
+
+    // Otherwise, a number is a virtual key code. The digit names come first,
+    // so the codes below 10 must be written in hexadecimal.
+    if (!std::isdigit(static_cast<unsigned char>(name[0])))
+        return false;
+    char* end = nullptr;
+    unsigned long number = std::strtoul(name, &end, 0);
+    if (*end != '\0' || number >= keyTableSize)
+        return false;
+    keyNumber = number;
+    return true;
+}
+
+const char* keyCategoryName(KeyCategory category)
+{
+    std::size_t index = static_cast<std::size_t>(category);
+    if (index >= keyCategoryCount)
+        return categoryNames[0];
+    return categoryNames[index];
+}
+
+bool keyCategoryFromName(const char* name, KeyCategory& category)
+{
+    if (!name)
+        return false;
+
+    for (std::size_t i = 0; i < keyCategoryCount; i++)
+    {
+        if (isSameName(categoryNames[i], name))
+        {
+            category = static_cast<KeyCategory>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -19,6 +19,7 @@
 #include "KeyboardHook.h"
 #include "KeyPressData.h"
 #include <iostream>
+#include <chrono>
 
 LRESULT CALLBACK keyHookProc(
     int nCode,
@@ -27,27 +28,46 @@ LRESULT CALLBACK keyHookProc(
 {
     if (nCode < 0)
         return CallNextHookEx(nullptr, nCode, wParam, lParam);
+
+    // The probe of the watchdog is never seen by the system.
+    PKBDLLHOOKSTRUCT p = (PKBDLLHOOKSTRUCT)lParam;
+    KeyPressData* keyPressData = KeyPressData::instance();
+    if (p->dwExtraInfo == hookProbeTag)
+    {
+        keyPressData->hookWatchdog().answerProbe();
+        return 1;
+    }
     
+    // The time spent in the callback is recorded, Windows remove
+    // the hook if it is too slow. The same time is the timestamp of the event.
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Translate the message into a key press or a key release
+    // and let the chatter engine decide if it is discarded.
+    bool isPressed = false;
     switch (wParam)
     {
         case WM_KEYDOWN:
         case WM_SYSKEYDOWN:
-        {
-            PKBDLLHOOKSTRUCT p = (PKBDLLHOOKSTRUCT)lParam;
-            bool result = KeyPressData::instance()->isKeyPressChatter(p->vkCode);
-            if (result)
-                return 1;
-        } break;
+            isPressed = true;
+            break;
 
         case WM_KEYUP:
         case WM_SYSKEYUP:
-        {
-            PKBDLLHOOKSTRUCT p = (PKBDLLHOOKSTRUCT)lParam;
-            bool result = KeyPressData::instance()->isKeyReleaseChatter(p->vkCode);
-            if (result)
-                return 1;
-        } break;
+            isPressed = false;
+            break;
+
+        default:
+            return CallNextHookEx(nullptr, nCode, wParam, lParam);
     }
 
+    const bool isInjected = (p->flags & LLKHF_INJECTED) != 0;
+    const bool isOwnRelease = isInjected && p->dwExtraInfo == releaseTag;
+    bool isBlocked = keyPressData->isKeyChatter(p->vkCode, isPressed, isInjected, isOwnRelease, startTime);
+    keyPressData->hookLatency().record(isPressed, isBlocked, std::chrono::steady_clock::now() - startTime);
+
+    if (isBlocked)
+        return 1;
+
     return CallNextHookEx(nullptr, nCode, wParam, lParam);
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "LatencyHistogram.h"
+
+#include <iomanip>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+    std::uint64_t value = duration.count() > 0 ? static_cast<std::uint64_t>(duration.count()) : 0;
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+
+    // The maximum rarely changes, the loop is almost never taken.
+    std::uint64_t max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    {}
+}
+
+void LatencyHistogram::reset()
+{
+    for (std::size_t i = 0; i < bucketCount; i++)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::count() const
+{
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < bucketCount; i++)
+        total += m_buckets[i].load(std::memory_order_relaxed);
+    return total;
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const
+{
+    return std::chrono::nanoseconds(m_max.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds LatencyHistogram::valueAtPercentile(double percentile) const
+{
+    // Return the highest value of the bucket holding the percentile,
+    // never higher than the maximum recorded.
+    std::uint64_t total = count();
+    if (total == 0)
+        return std::chrono::nanoseconds(0);
+
+    std::uint64_t rank = static_cast<std::uint64_t>(percentile / 100. * total + 0.5);
+    if (rank == 0)
+        rank = 1;
+    if (rank > total)
+        rank = total;
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucketCount; i++)
+    {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            std::uint64_t value = bucketHighestValue(i);
+            std::uint64_t max = m_max.load(std::memory_order_relaxed);
+            return std::chrono::nanoseconds(value < max ? value : max);
+        }
+    }
+
+    return max();
+}
+
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t value)
+{
+    // The values below 16 have their own bucket. Above, the bucket is given
+    // by the position of the highest bit and the 4 bits following it.
+    if (value < subBucketCount)
+        return static_cast<std::size_t>(value);
+
+    std::size_t highestBit = 0;
+    for (std::uint64_t v = value; v > 1; v >>= 1)
+        highestBit++;
+
+    std::size_t shift = highestBit - subBucketBits;
+    std::size_t index = (shift + 1) * subBucketCount + static_cast<std::size_t>((value >> shift) & (subBucketCount - 1));
+    return index < bucketCount ? index : bucketCount - 1;
+}
+
+std::uint64_t LatencyHistogram::bucketHighestValue(std::size_t index)
+{
+    if (index < subBucketCount)
+        return index;
+
+    std::size_t shift = index / subBucketCount - 1;
+    std::uint64_t subBucket = (index % subBucketCount) | subBucketCount;
+    return ((subBucket + 1) << shift) - 1;
+}
+
+HookLatency::HookLatency()
+{}
+
+void HookLatency::record(bool isPressed, bool isBlocked, std::chrono::nanoseconds duration)
+{
+    m_histograms[static_cast<std::size_t>(isPressed ? HookEventType::Press : HookEventType::Release)].record(duration);
+    m_histograms[static_cast<std::size_t>(isBlocked ? HookEventType::Blocked : HookEventType::Passed)].record(duration);
+}
+
+const LatencyHistogram& HookLatency::histogram(HookEventType type) const
+{
+    return m_histograms[static_cast<std::size_t>(type)];
+}
+
+void HookLatency::print(std::ostream& stream) const
+{
+    // Print the percentiles in microseconds of each type of event.
+    static const char* const names[eventTypeCount] = { "press", "release", "blocked", "passed" };
+    std::ios::fmtflags flags = stream.flags();
+
+    stream << "Hook callback latency (us):" << std::endl;
+    stream << std::left << std::setw(10) << "event" << std::right
+        << std::setw(12) << "count" << std::setw(10) << "p50" << std::setw(10) << "p99"
+        << std::setw(10) << "p99.9" << std::setw(10) << "max" << std::endl;
+    stream << std::fixed << std::setprecision(2);
+
+    for (std::size_t i = 0; i < eventTypeCount; i++)
+    {
+        const LatencyHistogram& h = m_histograms[i];
+        stream << std::left << std::setw(10) << names[i] << std::right
+            << std::setw(12) << h.count()
+            << std::setw(10) << h.valueAtPercentile(50.).count() / 1000.
+            << std::setw(10) << h.valueAtPercentile(99.).count() / 1000.
+            << std::setw(10) << h.valueAtPercentile(99.9).count() / 1000.
+            << std::setw(10) << h.max().count() / 1000. << std::endl;
+    }
+
+    stream.flags(flags);
+}
@@ -0,0 +1,281 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ReleaseScheduler.h"
+
+#include <algorithm>
+
+namespace
+{
+    const ChatterTime noWakeUpTime = ChatterTime::max();
+    // The wake up time of the thread while it works, the hook never wakes it up.
+    const ChatterTime::rep awakeTime = ChatterTime::min().count();
+    // Resolution of the timer wheel of the thread: one millisecond.
+    const std::int64_t wheelResolution = 1000;
+    const std::uint64_t claimedState = 1;
+}
+
+const std::size_t ReleaseScheduler::ringCapacity;
+
+ReleaseScheduler::ReleaseScheduler(ChatterEngine& engine, const ChatterClock& clock, ReleaseSink& sink,
+    ChatterTime batchTime) :
+    m_engine(engine),
+    m_clock(clock),
+    m_sink(sink),
+    m_slotCount(ChatterEngine::keyCount * engine.maxDeviceCount()),
+    m_isProcessing(false),
+    m_generation(0),
+    m_isScheduled(new bool[m_slotCount]()),
+    m_engineReleases(m_slotCount),
+    m_releaseStates(new std::atomic<std::uint64_t>[m_slotCount]),
+    m_wakeUpTime(awakeTime),
+    m_batchTime(batchTime.count()),
+    m_pendingReleases(m_slotCount),
+    m_wheel(m_slotCount, wheelResolution),
+    m_dueSlots(m_slotCount),
+    m_dueKeys(m_slotCount),
+    m_isRunning(true)
+{
+    for (std::size_t i = 0; i < m_slotCount; i++)
+        m_releaseStates[i] = 0;
+    m_thread = std::thread(&ReleaseScheduler::run, this);
+}
+
+ReleaseScheduler::~ReleaseScheduler()
+{
+    stop();
+}
+
+ChatterResult ReleaseScheduler::processKeyEvent(unsigned long key, bool isPressed)
+{
+    return processKeyEvent(key, isPressed, m_clock.now());
+}
+
+ChatterResult ReleaseScheduler::processKeyEvent(unsigned long key, bool isPressed, ChatterTime time)
+{
+    return processKeyEvent(defaultDevice, key, isPressed, time);
+}
+
+ChatterResult ReleaseScheduler::processKeyEvent(DeviceId device, unsigned long key, bool isPressed, ChatterTime time)
+{
+    // After a stall, the stalled hook thread may still be in the engine:
+    // the event of the other thread passes instead of waiting for it.
+    ChatterResult result = {};
+    result.decision = ChatterDecision::Pass;
+    if (m_isProcessing.exchange(true, std::memory_order_acquire))
+        return result;
+
+    // The engine forgets the releases due before the event, the thread sends them.
+    m_engine.releaseDueKeys(time, m_engineReleases);
+    std::size_t slot = 0;
+    for (std::size_t i = 0; i < m_engineReleases.size(); i++)
+    {
+        m_engine.isReleasePending(m_engineReleases.deviceAt(i), m_engineReleases.at(i), slot);
+        m_isScheduled[slot] = false;
+    }
+    m_engineReleases.clear();
+
+    // A release delayed again replaces the previous one, a release the engine
+    // no longer delays is claimed before the thread sends it.
+    result = m_engine.processKeyEvent(device, key, isPressed, time);
+    const bool isPending = m_engine.isReleasePending(device, key, slot);
+    if (result.decision == ChatterDecision::Delay)
+    {
+        // Without room in the ring, the release is sent at once.
+        if (!scheduleRelease(device, key, slot, result.releaseTime))
+            result.decision = ChatterDecision::Pass;
+    }
+    else if (!isPending && key < ChatterEngine::keyCount && m_isScheduled[slot])
+        cancelRelease(slot);
+
+    m_isProcessing.store(false, std::memory_order_release);
+    return result;
+}
+
+bool ReleaseScheduler::scheduleRelease(DeviceId device, unsigned long key, std::size_t slot, ChatterTime releaseTime)
+{
+    // The new generation makes the claim of a previous release of the slot fail.
+    const std::uint64_t generation = ++m_generation;
+    m_releaseStates[slot].store(generation << 1, std::memory_order_relaxed);
+    ScheduledRelease release = { device, key, slot, releaseTime, generation };
+    if (!m_scheduledReleases.push(release))
+    {
+        m_releaseStates[slot].store((generation << 1) | claimedState, std::memory_order_relaxed);
+        m_isScheduled[slot] = false;
+        return false;
+    }
+    m_isScheduled[slot] = true;
+
+    // Only wake up the thread if it sleeps past the batch of the release. The fence
+    // orders the push before reading its wake up time, the thread does the opposite.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (batchEndTime(releaseTime).count() < m_wakeUpTime.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_condition.notify_one();
+    }
+    return true;
+}
+
+void ReleaseScheduler::cancelRelease(std::size_t slot)
+{
+    // If the thread has claimed the release first, it is already sent.
+    m_isScheduled[slot] = false;
+    std::uint64_t state = m_releaseStates[slot].load(std::memory_order_relaxed);
+    if ((state & claimedState) == 0)
+        m_releaseStates[slot].compare_exchange_strong(state, state | claimedState, std::memory_order_relaxed);
+}
+
+void ReleaseScheduler::setChatterTime(ChatterTime time)
+{
+    // The engine publishes the new settings without the lock,
+    // so the hook is never waiting for a change of the settings.
+    m_engine.setChatterTime(time);
+}
+
+ChatterTime ReleaseScheduler::chatterTime() const
+{
+    return m_engine.chatterTime();
+}
+
+void ReleaseScheduler::setConfig(const ChatterConfig& config)
+{
+    m_engine.setConfig(config);
+}
+
+void ReleaseScheduler::setBatchTime(ChatterTime batchTime)
+{
+    m_batchTime.store(batchTime.count(), std::memory_order_relaxed);
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_condition.notify_one();
+}
+
+bool ReleaseScheduler::enableAdaptiveChatterTime(ChatterTime minimum, ChatterTime maximum)
+{
+    return m_engine.enableAdaptiveChatterTime(minimum, maximum);
+}
+
+void ReleaseScheduler::setStatistics(ChatterStatistics* statistics)
+{
+    m_engine.setStatistics(statistics);
+}
+
+void ReleaseScheduler::stop()
+{
+    // Ask the thread to exit and wait for it.
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_isRunning = false;
+        m_condition.notify_one();
+    }
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void ReleaseScheduler::run()
+{
+    /*
+    * Take the releases pushed by the hook, send the ones that are due,
+    * then sleep until the end of the batch of the earliest one. The lock
+    * is only held to go to sleep: the wake up time is published before
+    * looking at the ring again, the hook does the opposite, so either the
+    * thread sees the new release, or the hook wakes it up.
+    */
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (m_isRunning)
+    {
+        lock.unlock();
+        takeScheduledReleases();
+        const ChatterTime now = m_clock.now();
+        sendDueReleases(now);
+        std::int64_t deadline = 0;
+        const ChatterTime wakeUpTime = m_wheel.nextDeadline(deadline) ? batchEndTime(ChatterTime(deadline)) : noWakeUpTime;
+        lock.lock();
+
+        m_wakeUpTime.store(wakeUpTime.count(), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_isRunning && m_scheduledReleases.isEmpty())
+        {
+            if (wakeUpTime == noWakeUpTime)
+                m_condition.wait(lock);
+            else if (now < wakeUpTime)
+                m_condition.wait_for(lock, wakeUpTime - now);
+        }
+        m_wakeUpTime.store(awakeTime, std::memory_order_relaxed);
+    }
+}
+
+void ReleaseScheduler::takeScheduledReleases()
+{
+    // A release of a slot replaces the previous one.
+    ScheduledRelease release;
+    while (m_scheduledReleases.pop(release))
+    {
+        m_pendingReleases[release.slot] = release;
+        m_wheel.schedule(release.slot, release.releaseTime.count());
+    }
+}
+
+void ReleaseScheduler::sendDueReleases(ChatterTime now)
+{
+    // Claim the due releases, the ones replaced or cancelled by the hook meanwhile are dropped.
+    std::size_t dueCount = 0;
+    std::size_t count = 0;
+    do
+    {
+        count = m_wheel.popDue(now.count(), m_dueSlots.data() + dueCount, m_slotCount - dueCount);
+        for (std::size_t i = dueCount; i < dueCount + count; i++)
+        {
+            const std::size_t slot = m_dueSlots[i];
+            std::uint64_t state = m_pendingReleases[slot].generation << 1;
+            if (m_releaseStates[slot].compare_exchange_strong(state, state | claimedState, std::memory_order_relaxed))
+                m_dueSlots[dueCount++] = slot;
+        }
+    } while (count > 0 && dueCount < m_slotCount);
+
+    // The slots are sorted by device table, the keys of a device are sent together.
+    std::sort(m_dueSlots.begin(), m_dueSlots.begin() + dueCount);
+    for (std::size_t i = 0; i < dueCount; i++)
+    {
+        const ScheduledRelease& release = m_pendingReleases[m_dueSlots[i]];
+        m_dueKeys.releaseDeviceKeys(release.device, &release.key, 1);
+    }
+    for (std::size_t first = 0; first < m_dueKeys.size();)
+    {
+        std::size_t last = first + 1;
+        while (last < m_dueKeys.size() && m_dueKeys.deviceAt(last) == m_dueKeys.deviceAt(first))
+            last++;
+        m_sink.releaseDeviceKeys(m_dueKeys.deviceAt(first), m_dueKeys.keys() + first, last - first);
+        first = last;
+    }
+    m_dueKeys.clear();
+}
+
+ChatterTime ReleaseScheduler::batchEndTime(ChatterTime time) const
+{
+    // Round up to the next multiple of the batch time.
+    const ChatterTime::rep batch = m_batchTime.load(std::memory_order_relaxed);
+    if (batch <= 0 || time == noWakeUpTime)
+        return time;
+    const ChatterTime::rep remainder = time.count() % batch;
+    if (remainder == 0)
+        return time;
+    return ChatterTime(time.count() - remainder + batch);
+}
@@ -0,0 +1,86 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ReleaseSink.h"
+
+ReleaseSink::~ReleaseSink()
+{}
+
+void ReleaseSink::releaseKeys(const unsigned long* keys, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+        releaseKey(keys[i]);
+}
+
+void ReleaseSink::releaseDeviceKeys(DeviceId device, const unsigned long* keys, std::size_t count)
+{
+    (void)device;
+    releaseKeys(keys, count);
+}
+
+ReleaseBuffer::ReleaseBuffer(std::size_t capacity) :
+    m_capacity(capacity)
+{
+    m_keys.reserve(capacity);
+    m_devices.reserve(capacity);
+}
+
+void ReleaseBuffer::releaseKey(unsigned long key)
+{
+    releaseDeviceKeys(defaultDevice, &key, 1);
+}
+
+void ReleaseBuffer::releaseKeys(const unsigned long* keys, std::size_t count)
+{
+    releaseDeviceKeys(defaultDevice, keys, count);
+}
+
+void ReleaseBuffer::releaseDeviceKeys(DeviceId device, const unsigned long* keys, std::size_t count)
+{
+    for (std::size_t i = 0; i < count && m_keys.size() < m_capacity; i++)
+    {
+        m_keys.push_back(keys[i]);
+        m_devices.push_back(device);
+    }
+}
+
+std::size_t ReleaseBuffer::size() const
+{
+    return m_keys.size();
+}
+
+unsigned long ReleaseBuffer::at(std::size_t i) const
+{
+    return m_keys[i];
+}
+
+DeviceId ReleaseBuffer::deviceAt(std::size_t i) const
+{
+    return m_devices[i];
+}
+
+const unsigned long* ReleaseBuffer::keys() const
+{
+    return m_keys.data();
+}
+
+void ReleaseBuffer::clear()
+{
+    m_keys.clear();
+    m_devices.clear();
+}
@@ -0,0 +1,197 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "StatisticsFile.h"
+
+#include <ctime>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+StatisticsFile::StatisticsFile() :
+    m_data(nullptr),
+#ifdef _WIN32
+    m_file(INVALID_HANDLE_VALUE),
+    m_mapping(nullptr)
+#else
+    m_file(-1)
+#endif
+{}
+
+StatisticsFile::~StatisticsFile()
+{
+    close();
+}
+
+bool StatisticsFile::create(const std::string& path, std::string& error)
+{
+    if (!map(path, true, error))
+        return false;
+
+    // The file is new, so the counters are zero. The magic is written last,
+    // a reader opening the file meanwhile sees an invalid file.
+    ChatterStatistics* data = statistics();
+    data->version = chatterStatisticsVersion;
+    data->size = sizeof(ChatterStatistics);
+    data->keyCount = sizeof(data->keys) / sizeof(data->keys[0]);
+    data->counterCount = chatterCounterCount;
+#ifdef _WIN32
+    data->processId = static_cast<std::uint32_t>(GetCurrentProcessId());
+#else
+    data->processId = static_cast<std::uint32_t>(::getpid());
+#endif
+    data->startTime = static_cast<std::int64_t>(std::time(nullptr));
+    std::atomic_thread_fence(std::memory_order_release);
+    data->magic = chatterStatisticsMagic;
+    return true;
+}
+
+bool StatisticsFile::open(const std::string& path, std::string& error)
+{
+    if (!map(path, false, error))
+        return false;
+
+    const ChatterStatistics* data = statistics();
+    if (data->magic != chatterStatisticsMagic)
+        error = path + " is not a statistics file.";
+    else if (data->version != chatterStatisticsVersion || data->size != sizeof(ChatterStatistics))
+        error = path + " has the version " + std::to_string(data->version) +
+            ", expected " + std::to_string(chatterStatisticsVersion) + ".";
+    else
+        return true;
+
+    close();
+    return false;
+}
+
+#ifdef _WIN32
+
+bool StatisticsFile::map(const std::string& path, bool isWritable, std::string& error)
+{
+    close();
+
+    // The file can be read, and deleted, while it is mapped.
+    m_file = CreateFileA(path.c_str(), isWritable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+        isWritable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        error = "cannot open " + path + " (error " + std::to_string(GetLastError()) + ").";
+        return false;
+    }
+
+    // Mapping a new file extends it, with zeros.
+    m_mapping = CreateFileMappingA(m_file, nullptr, isWritable ? PAGE_READWRITE : PAGE_READONLY,
+        0, isWritable ? sizeof(ChatterStatistics) : 0, nullptr);
+    if (m_mapping != nullptr)
+        m_data = MapViewOfFile(m_mapping, isWritable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, sizeof(ChatterStatistics));
+
+    if (m_data == nullptr)
+    {
+        error = "cannot map " + path + " (error " + std::to_string(GetLastError()) + ").";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void StatisticsFile::close()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool StatisticsFile::map(const std::string& path, bool isWritable, std::string& error)
+{
+    close();
+
+    m_file = ::open(path.c_str(), isWritable ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+    if (m_file < 0)
+    {
+        error = "cannot open " + path + ": " + std::strerror(errno) + ".";
+        return false;
+    }
+
+    // A truncated file is extended with zeros.
+    struct stat fileStat = {};
+    if (isWritable && ::ftruncate(m_file, sizeof(ChatterStatistics)) != 0)
+        error = "cannot resize " + path + ": " + std::strerror(errno) + ".";
+    else if (!isWritable && (::fstat(m_file, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(ChatterStatistics))))
+        error = path + " is not a statistics file.";
+    else
+    {
+        void* data = ::mmap(nullptr, sizeof(ChatterStatistics), isWritable ? PROT_READ | PROT_WRITE : PROT_READ,
+            MAP_SHARED, m_file, 0);
+        if (data != MAP_FAILED)
+        {
+            m_data = data;
+            return true;
+        }
+        error = "cannot map " + path + ": " + std::strerror(errno) + ".";
+    }
+
+    close();
+    return false;
+}
+
+void StatisticsFile::close()
+{
+    if (m_data != nullptr)
+        ::munmap(m_data, sizeof(ChatterStatistics));
+    if (m_file >= 0)
+        ::close(m_file);
+
+    m_data = nullptr;
+    m_file = -1;
+}
+
+#endif
+
+bool StatisticsFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+ChatterStatistics* StatisticsFile::statistics()
+{
+    return static_cast<ChatterStatistics*>(m_data);
+}
+
+const ChatterStatistics* StatisticsFile::statistics() const
+{
+    return static_cast<const ChatterStatistics*>(m_data);
+}
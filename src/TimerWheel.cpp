@@ -0,0 +1,296 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "TimerWheel.h"
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Index of the lowest set bit, bits is not zero.
+    std::size_t countTrailingZeros(std::uint64_t bits)
+    {
+#if defined(__GNUC__)
+        return static_cast<std::size_t>(__builtin_ctzll(bits));
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index = 0;
+        _BitScanForward64(&index, bits);
+        return index;
+#else
+        std::size_t bit = 0;
+        while ((bits & 1) == 0)
+        {
+            bits >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+}
+
+TimerWheel::TimerWheel(std::size_t slotCount, std::int64_t resolution, std::size_t bucketCount) :
+    m_resolution(resolution > 0 ? resolution : 1),
+    m_currentTick(0),
+    m_pendingCount(0)
+{
+    // The bitmap of the non empty buckets is made of 64 bits words,
+    // so the number of buckets is rounded up to a multiple of 64.
+    if (bucketCount == 0)
+        bucketCount = 64;
+    bucketCount = (bucketCount + 63) / 64 * 64;
+
+    Slot emptySlot = {};
+    emptySlot.previous = -1;
+    emptySlot.next = -1;
+    emptySlot.bucket = -1;
+
+    m_slots.assign(slotCount, emptySlot);
+    m_buckets.assign(bucketCount, -1);
+    m_bucketBitmap.assign(bucketCount / 64, 0);
+}
+
+bool TimerWheel::schedule(std::size_t slot, std::int64_t deadline)
+{
+    // Insert the deadline of the slot into the bucket of its tick.
+    // If the slot is already pending, the previous deadline is replaced.
+    if (slot >= m_slots.size())
+        return false;
+
+    if (m_slots[slot].bucket >= 0)
+        unlink(slot);
+
+    // A deadline already in the past goes into the current bucket,
+    // it will be returned by the next call to popDue.
+    std::int64_t tick = deadline / m_resolution;
+    if (tick < m_currentTick)
+        tick = m_currentTick;
+
+    m_slots[slot].deadline = deadline;
+    link(slot, bucketOfTick(tick));
+    return true;
+}
+
+bool TimerWheel::cancel(std::size_t slot)
+{
+    if (!isPending(slot))
+        return false;
+
+    unlink(slot);
+    return true;
+}
+
+bool TimerWheel::isPending(std::size_t slot) const
+{
+    return slot < m_slots.size() && m_slots[slot].bucket >= 0;
+}
+
+bool TimerWheel::isEmpty() const
+{
+    return m_pendingCount == 0;
+}
+
+std::size_t TimerWheel::pendingCount() const
+{
+    return m_pendingCount;
+}
+
+std::size_t TimerWheel::slotCount() const
+{
+    return m_slots.size();
+}
+
+bool TimerWheel::nextDeadline(std::int64_t& deadline) const
+{
+    /*
+    * Walk the buckets starting at the current tick, skipping the empty ones
+    * using the bitmap. The first bucket holding a deadline of the current
+    * rotation gives the earliest deadline. If every deadline belongs
+    * to a later rotation, the smallest one is returned.
+    */
+    if (m_pendingCount == 0)
+        return false;
+
+    std::int64_t earliest = std::numeric_limits<std::int64_t>::max();
+    const std::size_t bucketCount = m_buckets.size();
+    const std::size_t start = bucketOfTick(m_currentTick);
+    std::size_t offset = 0;
+
+    while (offset < bucketCount)
+    {
+        const std::size_t position = (start + offset) % bucketCount;
+        std::size_t bucket = 0;
+        if (!findNonEmptyBucket(position, bucket))
+        {
+            // Nothing until the end of the bitmap, continue from its beginning.
+            offset += bucketCount - position;
+            continue;
+        }
+
+        offset += bucket - position;
+        if (offset >= bucketCount)
+            break;
+
+        const std::int64_t tick = m_currentTick + static_cast<std::int64_t>(offset);
+        bool isInThisRotation = false;
+        std::int64_t bucketEarliest = std::numeric_limits<std::int64_t>::max();
+        for (std::int32_t i = m_buckets[bucket]; i >= 0; i = m_slots[i].next)
+        {
+            const std::int64_t slotDeadline = m_slots[i].deadline;
+            if (slotDeadline / m_resolution <= tick)
+            {
+                isInThisRotation = true;
+                if (slotDeadline < bucketEarliest)
+                    bucketEarliest = slotDeadline;
+            }
+            if (slotDeadline < earliest)
+                earliest = slotDeadline;
+        }
+
+        if (isInThisRotation)
+        {
+            deadline = bucketEarliest;
+            return true;
+        }
+
+        offset++;
+    }
+
+    deadline = earliest;
+    return true;
+}
+
+std::size_t TimerWheel::popDue(std::int64_t now, std::size_t* slots, std::size_t maxSlots)
+{
+    /*
+    * Remove every slot whose deadline is lower or equal to now
+    * and write them into slots. The buckets between the last
+    * processed tick and the tick of now are visited once,
+    * skipping the empty ones using the bitmap.
+    */
+    const std::int64_t nowTick = now / m_resolution;
+    if (m_pendingCount == 0 || nowTick < m_currentTick)
+    {
+        if (nowTick > m_currentTick)
+            m_currentTick = nowTick;
+        return 0;
+    }
+
+    std::int64_t steps = nowTick - m_currentTick + 1;
+    if (steps > static_cast<std::int64_t>(m_buckets.size()))
+        steps = static_cast<std::int64_t>(m_buckets.size());
+
+    const std::size_t bucketCount = m_buckets.size();
+    std::size_t count = 0;
+    std::int64_t step = 0;
+    while (step < steps && m_pendingCount > 0)
+    {
+        const std::size_t position = bucketOfTick(m_currentTick + step);
+        std::size_t bucket = 0;
+        if (!findNonEmptyBucket(position, bucket))
+        {
+            // Nothing until the end of the bitmap, continue from its beginning.
+            step += static_cast<std::int64_t>(bucketCount - position);
+            continue;
+        }
+
+        step += static_cast<std::int64_t>(bucket - position);
+        if (step >= steps)
+            break;
+
+        std::int32_t i = m_buckets[bucket];
+        while (i >= 0)
+        {
+            const std::int32_t next = m_slots[i].next;
+            if (m_slots[i].deadline <= now)
+            {
+                // The output is full, continue from this tick next time.
+                if (count == maxSlots)
+                {
+                    m_currentTick += step;
+                    return count;
+                }
+                unlink(i);
+                slots[count++] = static_cast<std::size_t>(i);
+            }
+            i = next;
+        }
+        step++;
+    }
+
+    m_currentTick = nowTick;
+    return count;
+}
+
+std::size_t TimerWheel::bucketOfTick(std::int64_t tick) const
+{
+    const std::int64_t bucketCount = static_cast<std::int64_t>(m_buckets.size());
+    return static_cast<std::size_t>(((tick % bucketCount) + bucketCount) % bucketCount);
+}
+
+void TimerWheel::link(std::size_t slot, std::size_t bucket)
+{
+    // Insert the slot at the head of the list of the bucket.
+    Slot& s = m_slots[slot];
+    s.bucket = static_cast<std::int32_t>(bucket);
+    s.previous = -1;
+    s.next = m_buckets[bucket];
+    if (s.next >= 0)
+        m_slots[s.next].previous = static_cast<std::int32_t>(slot);
+    m_buckets[bucket] = static_cast<std::int32_t>(slot);
+    m_bucketBitmap[bucket / 64] |= std::uint64_t(1) << (bucket % 64);
+    m_pendingCount++;
+}
+
+void TimerWheel::unlink(std::size_t slot)
+{
+    Slot& s = m_slots[slot];
+    const std::size_t bucket = static_cast<std::size_t>(s.bucket);
+    if (s.previous >= 0)
+        m_slots[s.previous].next = s.next;
+    else
+        m_buckets[bucket] = s.next;
+    if (s.next >= 0)
+        m_slots[s.next].previous = s.previous;
+
+    if (m_buckets[bucket] < 0)
+        m_bucketBitmap[bucket / 64] &= ~(std::uint64_t(1) << (bucket % 64));
+
+    s.previous = -1;
+    s.next = -1;
+    s.bucket = -1;
+    m_pendingCount--;
+}
+
+bool TimerWheel::findNonEmptyBucket(std::size_t from, std::size_t& bucket) const
+{
+    // Find the first non empty bucket at or after from, without wrapping.
+    std::size_t word = from / 64;
+    std::uint64_t bits = m_bucketBitmap[word] & (~std::uint64_t(0) << (from % 64));
+    while (bits == 0)
+    {
+        if (++word == m_bucketBitmap.size())
+            return false;
+        bits = m_bucketBitmap[word];
+    }
+
+    bucket = word * 64 + countTrailingZeros(bits);
+    return true;
+}
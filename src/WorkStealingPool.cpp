@@ -0,0 +1,149 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(std::size_t threadCount) :
+    m_threadCount(threadCount),
+    m_task(nullptr),
+    m_batch(0),
+    m_remainingTasks(0),
+    m_busyWorkers(0),
+    m_isRunning(true),
+    m_stolenCount(0)
+{
+    if (m_threadCount == 0)
+        m_threadCount = std::thread::hardware_concurrency();
+    if (m_threadCount == 0)
+        m_threadCount = 1;
+
+    m_workers.reset(new Worker[m_threadCount]);
+    for (std::size_t i = 0; i < m_threadCount; i++)
+        m_workers[i].thread = std::thread(&WorkStealingPool::work, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isRunning = false;
+    }
+    m_batchCondition.notify_all();
+
+    for (std::size_t i = 0; i < m_threadCount; i++)
+        m_workers[i].thread.join();
+}
+
+std::size_t WorkStealingPool::threadCount() const
+{
+    return m_threadCount;
+}
+
+void WorkStealingPool::run(std::size_t taskCount, const std::function<void(std::size_t)>& task)
+{
+    if (taskCount == 0)
+        return;
+
+    {
+        // The tasks are queued with the task of the batch, so a thread
+        // never takes a task of this batch with the task of another one.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t i = 0; i < m_threadCount; i++)
+        {
+            std::lock_guard<std::mutex> workerLock(m_workers[i].mutex);
+            for (std::size_t j = taskCount * i / m_threadCount; j < taskCount * (i + 1) / m_threadCount; j++)
+                m_workers[i].tasks.push_back(j);
+        }
+        m_task = &task;
+        m_remainingTasks = taskCount;
+        m_batch++;
+    }
+    m_batchCondition.notify_all();
+
+    // Waiting for the threads still looking for a task, they could
+    // otherwise take a task of the next batch.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this]() { return m_remainingTasks == 0 && m_busyWorkers == 0; });
+    m_task = nullptr;
+}
+
+std::uint64_t WorkStealingPool::stolenCount() const
+{
+    return m_stolenCount.load(std::memory_order_relaxed);
+}
+
+void WorkStealingPool::work(std::size_t worker)
+{
+    std::uint64_t batch = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_batchCondition.wait(lock, [this, batch]() { return !m_isRunning || m_batch != batch; });
+        if (!m_isRunning)
+            return;
+        batch = m_batch;
+        if (!m_task)
+            continue;
+
+        const std::function<void(std::size_t)>& task = *m_task;
+        m_busyWorkers++;
+        lock.unlock();
+
+        std::size_t doneCount = 0;
+        std::size_t index;
+        while (takeTask(worker, index))
+        {
+            task(index);
+            doneCount++;
+        }
+
+        lock.lock();
+        m_busyWorkers--;
+        m_remainingTasks -= doneCount;
+        if (m_remainingTasks == 0 && m_busyWorkers == 0)
+            m_doneCondition.notify_one();
+    }
+}
+
+bool WorkStealingPool::takeTask(std::size_t worker, std::size_t& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_workers[worker].mutex);
+        if (!m_workers[worker].tasks.empty())
+        {
+            task = m_workers[worker].tasks.back();
+            m_workers[worker].tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Stealing from the front of the next queues, far from where their thread takes its tasks.
+    for (std::size_t i = 1; i < m_threadCount; i++)
+    {
+        Worker& victim = m_workers[(worker + i) % m_threadCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            m_stolenCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,608 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ChatterEngine.h"
+#include "DebugLog.h"
+#include "HookEventFilter.h"
+#include "HookWatchdog.h"
+#include "KeyEventRecording.h"
+#include "KeyEventTrace.h"
+#include "KeyTable.h"
+#include "LatencyHistogram.h"
+#include "ReleaseScheduler.h"
+#include "VirtualKeyCodes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+* Microbenchmark of the chatter engine hot paths: the press path,
+* the release path, the delayed release path and keyName.
+* Each path is measured on several synthetic event mixes, in nanoseconds
+* and heap allocations per event, for the filtering policies asked.
+* The hook path is the whole work of the keyboard hook for an event,
+* through the HookEventFilter of the program, for its policy only: the
+* release scheduler and the engine with its statistics, the debug log,
+* the recording, the watchdog and the latency histogram, the threads of
+* the release scheduler, of the debug log and of the recording working
+* meanwhile. Every allocation of the process is
+* counted, so the allocations of these threads are counted too.
+* The results are written as JSON. With --check, the program fails
+* if a path allocates, so an allocation added to a hot path is found.
+*/
+
+namespace
+{
+    std::atomic<std::uint64_t> allocationCount(0);
+}
+
+// Count every heap allocation made by the process.
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+    typedef std::chrono::steady_clock BenchClock;
+
+    struct BenchResult
+    {
+        std::string policy;
+        std::string mix;
+        std::string path;
+        std::uint64_t count;
+        double nsPerEvent;
+        double allocationsPerEvent;
+        std::uint64_t allocations;
+    };
+
+    struct PathCounter
+    {
+        PathCounter() :
+            count(0),
+            elapsed(0),
+            allocations(0)
+        {}
+
+        std::uint64_t count;
+        BenchClock::duration elapsed;
+        std::uint64_t allocations;
+    };
+
+    class CountingSink : public ReleaseSink
+    {
+    public:
+        CountingSink() : releasedCount(0) {}
+        void releaseKey(unsigned long) override { releasedCount++; }
+        std::uint64_t releasedCount;
+    };
+
+    // Stream buffer throwing away what is written, the stream stays good
+    // so the debug messages are still formatted.
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+#ifdef _WIN32
+    const char* const nullDevice = "NUL";
+#else
+    const char* const nullDevice = "/dev/null";
+#endif
+
+    // Keys of a 104 keys keyboard. The enter of the numpad share VK_RETURN.
+    const unsigned long fullKeyboard[] = {
+        VK_ESCAPE, VK_F1, VK_F2, VK_F3, VK_F4, VK_F5, VK_F6, VK_F7, VK_F8, VK_F9, VK_F10, VK_F11, VK_F12,
+        VK_SNAPSHOT, VK_SCROLL, VK_PAUSE,
+        VK_OEM_3, '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', VK_OEM_MINUS, VK_OEM_PLUS, VK_BACK,
+        VK_TAB, 'Q', 'W', 'E', 'R', 'T', 'Y', 'U', 'I', 'O', 'P', VK_OEM_4, VK_OEM_6, VK_OEM_5,
+        VK_CAPITAL, 'A', 'S', 'D', 'F', 'G', 'H', 'J', 'K', 'L', VK_OEM_1, VK_OEM_7, VK_RETURN,
+        VK_LSHIFT, 'Z', 'X', 'C', 'V', 'B', 'N', 'M', VK_OEM_COMMA, VK_OEM_PERIOD, VK_OEM_2, VK_RSHIFT,
+        VK_LCONTROL, VK_LWIN, VK_LMENU, VK_SPACE, VK_RMENU, VK_RWIN, VK_APPS, VK_RCONTROL,
+        VK_INSERT, VK_HOME, VK_PRIOR, VK_DELETE, VK_END, VK_NEXT,
+        VK_UP, VK_LEFT, VK_DOWN, VK_RIGHT,
+        VK_NUMLOCK, VK_DIVIDE, VK_MULTIPLY, VK_SUBTRACT, VK_ADD, VK_DECIMAL,
+        VK_NUMPAD0, VK_NUMPAD1, VK_NUMPAD2, VK_NUMPAD3, VK_NUMPAD4,
+        VK_NUMPAD5, VK_NUMPAD6, VK_NUMPAD7, VK_NUMPAD8, VK_NUMPAD9, VK_RETURN
+    };
+    const std::size_t fullKeyboardSize = sizeof(fullKeyboard) / sizeof(fullKeyboard[0]);
+
+    void addEvent(std::vector<KeyEvent>& events, double time, unsigned long key, bool isPressed)
+    {
+        KeyEvent event = {};
+        event.time = chatterTimeFromMilliseconds(time);
+        event.key = key;
+        event.isPressed = isPressed;
+        events.push_back(event);
+    }
+
+    void sortEvents(std::vector<KeyEvent>& events, std::size_t count)
+    {
+        std::stable_sort(events.begin(), events.end(), [](const KeyEvent& a, const KeyEvent& b) {
+            return a.time < b.time;
+        });
+        if (events.size() > count)
+            events.resize(count);
+    }
+
+    double uniform(std::mt19937& random, double min, double max)
+    {
+        return std::uniform_real_distribution<double>(min, max)(random);
+    }
+
+    unsigned long typingKey(std::mt19937& random)
+    {
+        // Letters most of the time, sometimes a space.
+        int n = std::uniform_int_distribution<int>(0, 31)(random);
+        return n < 26 ? 'A' + n : VK_SPACE;
+    }
+
+    // Burst of words, with some key rollover.
+    std::vector<KeyEvent> typingMix(std::size_t count, bool isChattering)
+    {
+        std::mt19937 random(isChattering ? 2 : 1);
+        std::vector<KeyEvent> events;
+        events.reserve(count + 64);
+        double time = 0.;
+
+        while (events.size() < count)
+        {
+            int burstLength = std::uniform_int_distribution<int>(3, 12)(random);
+            for (int i = 0; i < burstLength; i++)
+            {
+                unsigned long key = typingKey(random);
+                double releaseTime = time + uniform(random, 60., 140.);
+                addEvent(events, time, key, true);
+                addEvent(events, releaseTime, key, false);
+
+                // A chattering switch bounces after the press and after the release.
+                if (isChattering)
+                {
+                    double bounce = time + uniform(random, 1., 5.);
+                    addEvent(events, bounce, key, false);
+                    addEvent(events, bounce + uniform(random, 1., 5.), key, true);
+                    bounce = releaseTime + uniform(random, 1., 5.);
+                    addEvent(events, bounce, key, true);
+                    addEvent(events, bounce + uniform(random, 1., 5.), key, false);
+                }
+
+                time += uniform(random, 70., 220.);
+            }
+            time += uniform(random, 300., 1500.);
+        }
+
+        sortEvents(events, count);
+        return events;
+    }
+
+    // A key held down and repeated by the system.
+    std::vector<KeyEvent> autorepeatMix(std::size_t count)
+    {
+        std::mt19937 random(3);
+        std::vector<KeyEvent> events;
+        events.reserve(count + 64);
+        double time = 0.;
+
+        while (events.size() < count)
+        {
+            unsigned long key = typingKey(random);
+            double releaseTime = time + uniform(random, 500., 1500.);
+            addEvent(events, time, key, true);
+            for (double repeatTime = time + 500.; repeatTime < releaseTime; repeatTime += 33.)
+                addEvent(events, repeatTime, key, true);
+            addEvent(events, releaseTime, key, false);
+            time = releaseTime + uniform(random, 100., 400.);
+        }
+
+        sortEvents(events, count);
+        return events;
+    }
+
+    // Every key of the keyboard used at the same time.
+    std::vector<KeyEvent> allKeysMix(std::size_t count)
+    {
+        std::mt19937 random(4);
+        std::vector<KeyEvent> events;
+        events.reserve(count + 64);
+        std::vector<double> pressTime(fullKeyboardSize, -1.);
+        double time = 0.;
+
+        while (events.size() < count)
+        {
+            std::size_t i = std::uniform_int_distribution<std::size_t>(0, fullKeyboardSize - 1)(random);
+            if (pressTime[i] < 0.)
+            {
+                addEvent(events, time, fullKeyboard[i], true);
+                pressTime[i] = time;
+            }
+            else if (time - pressTime[i] > 30.)
+            {
+                addEvent(events, time, fullKeyboard[i], false);
+                pressTime[i] = -1.;
+            }
+            time += uniform(random, 0.5, 5.);
+        }
+
+        sortEvents(events, count);
+        return events;
+    }
+
+    double timerOverhead()
+    {
+        // Average cost of reading the clock, removed from the per call measures.
+        const int iterations = 1000000;
+        BenchClock::duration elapsed(0);
+        for (int i = 0; i < iterations; i++)
+        {
+            BenchClock::time_point start = BenchClock::now();
+            elapsed += BenchClock::now() - start;
+        }
+        return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    }
+
+    BenchResult makeResult(const std::string& mix, const std::string& path, const PathCounter& counter, double overhead)
+    {
+        BenchResult result;
+        result.mix = mix;
+        result.path = path;
+        result.count = counter.count;
+        result.nsPerEvent = 0.;
+        result.allocationsPerEvent = 0.;
+        result.allocations = counter.allocations;
+        if (counter.count > 0)
+        {
+            result.nsPerEvent = std::chrono::duration<double, std::nano>(counter.elapsed).count() / counter.count - overhead;
+            if (result.nsPerEvent < 0.)
+                result.nsPerEvent = 0.;
+            result.allocationsPerEvent = double(counter.allocations) / counter.count;
+        }
+        return result;
+    }
+
+    void benchHook(const std::string& mix, const std::vector<KeyEvent>& events, ChatterTime chatterTime,
+        std::vector<BenchResult>& results)
+    {
+        // The events go through the HookEventFilter of KeyPressData, the delayed
+        // releases are sent by the thread of the release scheduler meanwhile.
+        ChatterEngine engine;
+        engine.setChatterTime(chatterTime);
+        ChatterStatistics statistics = {};
+        ManualChatterClock clock;
+        CountingSink sink;
+        ReleaseScheduler releaseScheduler(engine, clock, sink);
+        releaseScheduler.setStatistics(&statistics);
+        NullBuffer nullBuffer;
+        std::ostream nullStream(&nullBuffer);
+        HookWatchdog watchdog(clock, nullStream);
+        HookLatency latency;
+        DebugLog debugLog(nullStream);
+        KeyEventRecorder recorder;
+        std::string error;
+        if (!recorder.open(nullDevice, error))
+            std::fprintf(stderr, "Cannot record the events, %s\n", error.c_str());
+        const std::atomic<bool> isDebugEnabled(true);
+        HookEventFilter hookEventFilter(releaseScheduler, watchdog, debugLog, recorder, isDebugEnabled);
+        PathCounter hook;
+
+        std::uint64_t allocations = allocationCount.load();
+        BenchClock::time_point start = BenchClock::now();
+        for (const KeyEvent& event : events)
+        {
+            BenchClock::time_point eventStart = BenchClock::now();
+            clock.setTime(event.time);
+            const ChatterDecision decision = hookEventFilter.filter(event.key, event.isPressed, false, false, event.time);
+            latency.record(event.isPressed, decision != ChatterDecision::Pass, BenchClock::now() - eventStart);
+        }
+        hook.elapsed = BenchClock::now() - start;
+
+        // The releases and the records still queued are sent and written before counting.
+        releaseScheduler.stop();
+        debugLog.stop();
+        recorder.close();
+        hook.allocations = allocationCount.load() - allocations;
+        hook.count = events.size();
+        results.push_back(makeResult(mix, "hook", hook, 0.));
+    }
+
+    template<typename Policy>
+    void benchMix(const std::string& mix, const std::vector<KeyEvent>& events, ChatterTime chatterTime,
+        double overhead, std::vector<BenchResult>& results)
+    {
+        // Whole trace, without any timer around the calls.
+        {
+            BasicChatterEngine<Policy> engine;
+            engine.setChatterTime(chatterTime);
+            CountingSink sink;
+            PathCounter total;
+
+            std::uint64_t allocations = allocationCount.load();
+            BenchClock::time_point start = BenchClock::now();
+            for (const KeyEvent& event : events)
+            {
+                engine.releaseDueKeys(event.time, sink);
+                engine.processKeyEvent(event.key, event.isPressed, event.time);
+            }
+            total.elapsed = BenchClock::now() - start;
+            total.allocations = allocationCount.load() - allocations;
+            total.count = events.size();
+            results.push_back(makeResult(mix, "all", total, 0.));
+        }
+
+        // Whole trace through the work of the keyboard hook, for the policy of the program.
+        if (std::is_same<BasicChatterEngine<Policy>, ChatterEngine>::value)
+            benchHook(mix, events, chatterTime, results);
+
+        // Each path timed separately.
+        BasicChatterEngine<Policy> engine;
+        engine.setChatterTime(chatterTime);
+        CountingSink sink;
+        PathCounter press;
+        PathCounter release;
+        PathCounter delayedRelease;
+
+        for (const KeyEvent& event : events)
+        {
+            ChatterTime releaseTime;
+            while (engine.nextReleaseTime(releaseTime) && releaseTime <= event.time)
+            {
+                std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed);
+                BenchClock::time_point start = BenchClock::now();
+                engine.releaseDueKeys(releaseTime, sink);
+                delayedRelease.elapsed += BenchClock::now() - start;
+                delayedRelease.allocations += allocationCount.load(std::memory_order_relaxed) - allocations;
+                delayedRelease.count++;
+            }
+
+            PathCounter& counter = event.isPressed ? press : release;
+            std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed);
+            BenchClock::time_point start = BenchClock::now();
+            engine.processKeyEvent(event.key, event.isPressed, event.time);
+            counter.elapsed += BenchClock::now() - start;
+            counter.allocations += allocationCount.load(std::memory_order_relaxed) - allocations;
+            counter.count++;
+        }
+
+        results.push_back(makeResult(mix, "press", press, overhead));
+        results.push_back(makeResult(mix, "release", release, overhead));
+        results.push_back(makeResult(mix, "delayed-release", delayedRelease, overhead));
+    }
+
+    // The policies compiled into the library, see ChatterPolicy.h.
+    struct PolicyBench
+    {
+        const char* name;
+        void (*benchMix)(const std::string& mix, const std::vector<KeyEvent>& events, ChatterTime chatterTime,
+            double overhead, std::vector<BenchResult>& results);
+    };
+
+    const PolicyBench policies[] = {
+        { "default", &benchMix<DefaultChatterPolicy> },
+        { "fixed-window", &benchMix<FixedWindowPolicy> },
+        { "press-only", &benchMix<PressOnlyPolicy> },
+        { "release-defer", &benchMix<ReleaseDeferPolicy> },
+        { "count-in-window", &benchMix<CountInWindowPolicy<2> > },
+        { "adaptive", &benchMix<AdaptivePolicy> }
+    };
+    const std::size_t policyCount = sizeof(policies) / sizeof(policies[0]);
+
+    void benchKeyName(std::size_t count, std::vector<BenchResult>& results)
+    {
+        // Names of all the virtual key codes, one after the other.
+        PathCounter counter;
+        std::size_t length = 0;
+        std::uint64_t allocations = allocationCount.load();
+        BenchClock::time_point start = BenchClock::now();
+        for (std::size_t i = 0; i < count; i++)
+            length += std::strlen(keyName(static_cast<unsigned long>(i & 0xFF)));
+        counter.elapsed = BenchClock::now() - start;
+        counter.allocations = allocationCount.load() - allocations;
+        counter.count = count;
+
+        results.push_back(makeResult("all-codes", "keyName", counter, 0.));
+        results.back().policy = "none";
+        if (length == 0)
+            std::fprintf(stderr, "Unexpected empty key names.\n");
+    }
+
+    void writeJson(std::FILE* file, const std::vector<BenchResult>& results, std::size_t eventCount,
+        ChatterTime chatterTime, double overhead)
+    {
+        std::fprintf(file, "{\n");
+        std::fprintf(file, "  \"benchmark\": \"KeyChatteringBench\",\n");
+        std::fprintf(file, "  \"events\": %zu,\n", eventCount);
+        std::fprintf(file, "  \"chatterTimeMs\": %.3f,\n", chatterTimeToMilliseconds(chatterTime));
+        std::fprintf(file, "  \"timerOverheadNs\": %.2f,\n", overhead);
+        std::fprintf(file, "  \"results\": [\n");
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            const BenchResult& r = results[i];
+            std::fprintf(file, "    {\"policy\": \"%s\", \"mix\": \"%s\", \"path\": \"%s\", \"count\": %llu, \"nsPerEvent\": %.2f, \"allocationsPerEvent\": %.4f}%s\n",
+                r.policy.c_str(), r.mix.c_str(), r.path.c_str(), static_cast<unsigned long long>(r.count),
+                r.nsPerEvent, r.allocationsPerEvent, i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+    }
+
+    void printUsage()
+    {
+        std::printf(
+            "Usage: KeyChatteringBench [options]\n"
+            "Benchmark the chatter engine hot paths and print the results as JSON.\n"
+            "  -e, --events=<n>      Number of events of each mix (default 1000000).\n"
+            "  -t, --time=<ms>       Time of chatter (default 50).\n"
+            "  -p, --policy=<name>   Filtering policy: default, fixed-window, press-only, release-defer,\n"
+            "                        count-in-window, adaptive or all (default default).\n"
+            "  -o, --output=<file>   Write the JSON into a file instead of the standard output.\n"
+            "  -c, --check           Fail if a path allocates on the heap.\n"
+            "  -h, --help            Print usage information.\n");
+    }
+
+    const char* optionValue(int argc, char** argv, int& i, const char* shortName, const char* longName)
+    {
+        // Return the value of --long=value or -s value, nullptr if argv[i] is not this option.
+        std::size_t longLength = std::strlen(longName);
+        if (std::strncmp(argv[i], longName, longLength) == 0 && argv[i][longLength] == '=')
+            return argv[i] + longLength + 1;
+        if (std::strcmp(argv[i], shortName) == 0)
+            return i + 1 < argc ? argv[++i] : "";
+        return nullptr;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t eventCount = 1000000;
+    double chatterTime = 50.;
+    const char* outputPath = nullptr;
+    const char* policyName = "default";
+    bool isCheck = false;
+
+    // Parsing the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        const char* value = nullptr;
+        if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0)
+        {
+            printUsage();
+            return EXIT_SUCCESS;
+        }
+        else if (std::strcmp(argv[i], "-c") == 0 || std::strcmp(argv[i], "--check") == 0)
+            isCheck = true;
+        else if ((value = optionValue(argc, argv, i, "-e", "--events")) != nullptr)
+        {
+            eventCount = std::strtoul(value, nullptr, 10);
+            if (eventCount == 0)
+            {
+                std::fprintf(stderr, "-e, --events, invalid argument. The argument must be a positive number.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((value = optionValue(argc, argv, i, "-t", "--time")) != nullptr)
+        {
+            char* end = nullptr;
+            chatterTime = std::strtod(value, &end);
+            if (end == value || *end != '\0' || !isValidChatterTime(chatterTime))
+            {
+                std::fprintf(stderr, "-t, --time, invalid argument. The argument must be a number of milliseconds between 0.001 and 10000.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((value = optionValue(argc, argv, i, "-p", "--policy")) != nullptr)
+        {
+            policyName = value;
+            bool isKnown = std::strcmp(policyName, "all") == 0;
+            for (std::size_t p = 0; p < policyCount; p++)
+                isKnown = isKnown || std::strcmp(policyName, policies[p].name) == 0;
+            if (!isKnown)
+            {
+                std::fprintf(stderr, "-p, --policy, invalid argument. Unknown policy %s.\n", policyName);
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((value = optionValue(argc, argv, i, "-o", "--output")) != nullptr)
+            outputPath = value;
+        else
+        {
+            std::fprintf(stderr, "Unknown option %s.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const double overhead = timerOverhead();
+    std::vector<BenchResult> results;
+
+    const std::vector<KeyEvent> typing = typingMix(eventCount, false);
+    const std::vector<KeyEvent> autorepeat = autorepeatMix(eventCount);
+    const std::vector<KeyEvent> chatter = typingMix(eventCount, true);
+    const std::vector<KeyEvent> allKeys = allKeysMix(eventCount);
+
+    for (std::size_t p = 0; p < policyCount; p++)
+    {
+        const PolicyBench& policy = policies[p];
+        if (std::strcmp(policyName, "all") != 0 && std::strcmp(policyName, policy.name) != 0)
+            continue;
+
+        const std::size_t firstResult = results.size();
+        policy.benchMix("typing", typing, chatterTimeFromMilliseconds(chatterTime), overhead, results);
+        policy.benchMix("autorepeat", autorepeat, chatterTimeFromMilliseconds(chatterTime), overhead, results);
+        policy.benchMix("chatter", chatter, chatterTimeFromMilliseconds(chatterTime), overhead, results);
+        policy.benchMix("all-keys", allKeys, chatterTimeFromMilliseconds(chatterTime), overhead, results);
+        for (std::size_t i = firstResult; i < results.size(); i++)
+            results[i].policy = policy.name;
+    }
+    benchKeyName(eventCount, results);
+
+    std::FILE* file = stdout;
+    if (outputPath)
+    {
+        file = std::fopen(outputPath, "w");
+        if (!file)
+        {
+            std::fprintf(stderr, "Cannot open %s.\n", outputPath);
+            return EXIT_FAILURE;
+        }
+    }
+
+    writeJson(file, results, eventCount, chatterTimeFromMilliseconds(chatterTime), overhead);
+
+    if (file != stdout)
+        std::fclose(file);
+
+    // The hot paths must never allocate, whatever the events.
+    if (isCheck)
+    {
+        bool isAllocating = false;
+        for (const BenchResult& r : results)
+        {
+            if (r.allocations > 0)
+            {
+                std::fprintf(stderr, "The %s path of the %s policy allocates on the %s mix: %llu allocations for %llu events.\n",
+                    r.path.c_str(), r.policy.c_str(), r.mix.c_str(),
+                    static_cast<unsigned long long>(r.allocations), static_cast<unsigned long long>(r.count));
+                isAllocating = true;
+            }
+        }
+        if (isAllocating)
+            return EXIT_FAILURE;
+        std::fprintf(stderr, "No allocation on the hot paths.\n");
+    }
+    return EXIT_SUCCESS;
+}
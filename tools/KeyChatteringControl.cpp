@@ -0,0 +1,80 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ControlServer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+/*
+* Send a request to the control endpoint of a running KeyChattering
+* (named pipe) or KeyChatteringFilter (Unix socket) and print the response.
+* The words after the endpoint form the request, "stats" by default.
+* The program fails if the request fails.
+*/
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout <<
+            "Usage: KeyChatteringControl <endpoint> [request]\n"
+            "Send a request to a running program started with --control=<endpoint>.\n"
+            "Requests:\n"
+            "  ping              Check the program is answering.\n"
+            "  stats             Counters of each key (default).\n"
+            "  latency           Percentiles of the time spent in the keyboard hook.\n"
+            "  watchdog          Stalls and drops of the keyboard hook.\n"
+            "  time [<ms>]       Print or change the time of chatter.\n"
+            "  reload            Read the configuration file again.\n"
+            "  debug [on|off]    Print or change the debug output.\n"
+            "  help              List the requests known by the program." << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || std::strcmp(argv[1], "-h") == 0 || std::strcmp(argv[1], "--help") == 0)
+    {
+        printUsage();
+        return argc < 2 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    std::string request;
+    for (int i = 2; i < argc; i++)
+    {
+        if (!request.empty())
+            request += ' ';
+        request += argv[i];
+    }
+    if (request.empty())
+        request = "stats";
+
+    std::string response;
+    std::string error;
+    if (!sendControlRequest(argv[1], request, response, error))
+    {
+        std::cerr << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << response << std::flush;
+    return response.compare(0, 6, "error ") == 0 || response.find("\nerror ") != std::string::npos ? EXIT_FAILURE : EXIT_SUCCESS;
+}
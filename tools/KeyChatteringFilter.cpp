@@ -0,0 +1,604 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ChatterReplay.h"
+#include "ConfigWatcher.h"
+#include "ControlServer.h"
+#include "StatisticsFile.h"
+#include "VirtualKeyCodes.h"
+
+#include <linux/input.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+/*
+* Debounce a stream of Linux input_event records, read from a file,
+* an evdev device or the standard input, and write them to the standard
+* output in the same format. The EV_KEY events go through the chatter
+* engine: the chattering presses are removed, the delayed releases are
+* removed and written back, followed by a SYN_REPORT, when they are due.
+* Every other event is written untouched.
+*
+* The engine, the configuration file and the statistics know the keys by
+* their Windows virtual key code, so the evdev codes are translated into
+* virtual key codes, and back for the releases written by the filter.
+* The keys without virtual key code (buttons, rare keys) are not filtered.
+* Like the Windows hook, two keys with the same virtual key code (the
+* enter keys) share their chatter data.
+*
+* The time of the events is the one of the records, so a capture
+* is filtered as fast as possible with the same result as if it was
+* received live. When the input is a device or a pipe and is idle,
+* the delayed releases are written when they are due, estimated from
+* the arrival of the last record.
+*
+* The records are read and written by batches of bufferSize.
+*
+* With --control, a Unix socket answers the requests of KeyChatteringControl.
+* A new time of chatter is applied by the filtering loop before the next read.
+*/
+
+namespace
+{
+    const std::size_t bufferSize = 1024;
+
+    struct EvdevKey
+    {
+        unsigned short code;
+        unsigned char key;
+    };
+
+    // Virtual key code of the evdev key codes of a keyboard.
+    const EvdevKey evdevKeys[] = {
+        { KEY_ESC, VK_ESCAPE }, { KEY_1, '1' }, { KEY_2, '2' }, { KEY_3, '3' }, { KEY_4, '4' }, { KEY_5, '5' },
+        { KEY_6, '6' }, { KEY_7, '7' }, { KEY_8, '8' }, { KEY_9, '9' }, { KEY_0, '0' },
+        { KEY_MINUS, VK_OEM_MINUS }, { KEY_EQUAL, VK_OEM_PLUS }, { KEY_BACKSPACE, VK_BACK }, { KEY_TAB, VK_TAB },
+        { KEY_Q, 'Q' }, { KEY_W, 'W' }, { KEY_E, 'E' }, { KEY_R, 'R' }, { KEY_T, 'T' }, { KEY_Y, 'Y' },
+        { KEY_U, 'U' }, { KEY_I, 'I' }, { KEY_O, 'O' }, { KEY_P, 'P' },
+        { KEY_LEFTBRACE, VK_OEM_4 }, { KEY_RIGHTBRACE, VK_OEM_6 }, { KEY_ENTER, VK_RETURN }, { KEY_LEFTCTRL, VK_LCONTROL },
+        { KEY_A, 'A' }, { KEY_S, 'S' }, { KEY_D, 'D' }, { KEY_F, 'F' }, { KEY_G, 'G' }, { KEY_H, 'H' },
+        { KEY_J, 'J' }, { KEY_K, 'K' }, { KEY_L, 'L' },
+        { KEY_SEMICOLON, VK_OEM_1 }, { KEY_APOSTROPHE, VK_OEM_7 }, { KEY_GRAVE, VK_OEM_3 }, { KEY_LEFTSHIFT, VK_LSHIFT },
+        { KEY_BACKSLASH, VK_OEM_5 },
+        { KEY_Z, 'Z' }, { KEY_X, 'X' }, { KEY_C, 'C' }, { KEY_V, 'V' }, { KEY_B, 'B' }, { KEY_N, 'N' }, { KEY_M, 'M' },
+        { KEY_COMMA, VK_OEM_COMMA }, { KEY_DOT, VK_OEM_PERIOD }, { KEY_SLASH, VK_OEM_2 }, { KEY_RIGHTSHIFT, VK_RSHIFT },
+        { KEY_KPASTERISK, VK_MULTIPLY }, { KEY_LEFTALT, VK_LMENU }, { KEY_SPACE, VK_SPACE }, { KEY_CAPSLOCK, VK_CAPITAL },
+        { KEY_F1, VK_F1 }, { KEY_F2, VK_F2 }, { KEY_F3, VK_F3 }, { KEY_F4, VK_F4 }, { KEY_F5, VK_F5 }, { KEY_F6, VK_F6 },
+        { KEY_F7, VK_F7 }, { KEY_F8, VK_F8 }, { KEY_F9, VK_F9 }, { KEY_F10, VK_F10 }, { KEY_F11, VK_F11 }, { KEY_F12, VK_F12 },
+        { KEY_NUMLOCK, VK_NUMLOCK }, { KEY_SCROLLLOCK, VK_SCROLL },
+        { KEY_KP7, VK_NUMPAD7 }, { KEY_KP8, VK_NUMPAD8 }, { KEY_KP9, VK_NUMPAD9 }, { KEY_KPMINUS, VK_SUBTRACT },
+        { KEY_KP4, VK_NUMPAD4 }, { KEY_KP5, VK_NUMPAD5 }, { KEY_KP6, VK_NUMPAD6 }, { KEY_KPPLUS, VK_ADD },
+        { KEY_KP1, VK_NUMPAD1 }, { KEY_KP2, VK_NUMPAD2 }, { KEY_KP3, VK_NUMPAD3 }, { KEY_KP0, VK_NUMPAD0 },
+        { KEY_KPDOT, VK_DECIMAL }, { KEY_102ND, VK_OEM_102 }, { KEY_KPENTER, VK_RETURN }, { KEY_RIGHTCTRL, VK_RCONTROL },
+        { KEY_KPSLASH, VK_DIVIDE }, { KEY_SYSRQ, VK_SNAPSHOT }, { KEY_RIGHTALT, VK_RMENU },
+        { KEY_HOME, VK_HOME }, { KEY_UP, VK_UP }, { KEY_PAGEUP, VK_PRIOR }, { KEY_LEFT, VK_LEFT }, { KEY_RIGHT, VK_RIGHT },
+        { KEY_END, VK_END }, { KEY_DOWN, VK_DOWN }, { KEY_PAGEDOWN, VK_NEXT }, { KEY_INSERT, VK_INSERT }, { KEY_DELETE, VK_DELETE },
+        { KEY_MUTE, VK_VOLUME_MUTE }, { KEY_VOLUMEDOWN, VK_VOLUME_DOWN }, { KEY_VOLUMEUP, VK_VOLUME_UP },
+        { KEY_PAUSE, VK_PAUSE }, { KEY_HANGEUL, VK_KANA }, { KEY_HANJA, VK_HANJA },
+        { KEY_LEFTMETA, VK_LWIN }, { KEY_RIGHTMETA, VK_RWIN }, { KEY_COMPOSE, VK_APPS },
+        { KEY_STOP, VK_BROWSER_STOP }, { KEY_HELP, VK_HELP }, { KEY_SLEEP, VK_SLEEP }, { KEY_MAIL, VK_LAUNCH_MAIL },
+        { KEY_BOOKMARKS, VK_BROWSER_FAVORITES }, { KEY_BACK, VK_BROWSER_BACK }, { KEY_FORWARD, VK_BROWSER_FORWARD },
+        { KEY_NEXTSONG, VK_MEDIA_NEXT_TRACK }, { KEY_PLAYPAUSE, VK_MEDIA_PLAY_PAUSE }, { KEY_PREVIOUSSONG, VK_MEDIA_PREV_TRACK },
+        { KEY_STOPCD, VK_MEDIA_STOP }, { KEY_HOMEPAGE, VK_BROWSER_HOME }, { KEY_REFRESH, VK_BROWSER_REFRESH },
+        { KEY_F13, VK_F13 }, { KEY_F14, VK_F14 }, { KEY_F15, VK_F15 }, { KEY_F16, VK_F16 }, { KEY_F17, VK_F17 },
+        { KEY_F18, VK_F18 }, { KEY_F19, VK_F19 }, { KEY_F20, VK_F20 }, { KEY_F21, VK_F21 }, { KEY_F22, VK_F22 },
+        { KEY_F23, VK_F23 }, { KEY_F24, VK_F24 }, { KEY_SEARCH, VK_BROWSER_SEARCH }, { KEY_MEDIA, VK_LAUNCH_MEDIA_SELECT },
+        { KEY_HENKAN, VK_CONVERT }, { KEY_MUHENKAN, VK_NONCONVERT }
+    };
+
+    ChatterTime eventTime(const input_event& event)
+    {
+#ifdef input_event_sec
+        return ChatterTime(static_cast<std::int64_t>(event.input_event_sec) * 1000000 + event.input_event_usec);
+#else
+        return ChatterTime(static_cast<std::int64_t>(event.time.tv_sec) * 1000000 + event.time.tv_usec);
+#endif
+    }
+
+    void setEventTime(input_event& event, ChatterTime time)
+    {
+#ifdef input_event_sec
+        event.input_event_sec = time.count() / 1000000;
+        event.input_event_usec = time.count() % 1000000;
+#else
+        event.time.tv_sec = time.count() / 1000000;
+        event.time.tv_usec = time.count() % 1000000;
+#endif
+    }
+
+    bool writeAll(int fd, const char* data, std::size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+
+    // Output buffer of records, written with one write for up to bufferSize records.
+    class EventWriter
+    {
+    public:
+        explicit EventWriter(int fd) :
+            m_fd(fd),
+            m_count(0),
+            m_isFailed(false)
+        {}
+
+        void push(const input_event& event)
+        {
+            if (m_count == bufferSize)
+                flush();
+            m_events[m_count++] = event;
+        }
+
+        void flush()
+        {
+            if (m_count > 0 && !m_isFailed)
+                m_isFailed = !writeAll(m_fd, reinterpret_cast<const char*>(m_events), m_count * sizeof(input_event));
+            m_count = 0;
+        }
+
+        bool isFailed() const
+        {
+            return m_isFailed;
+        }
+
+    private:
+        int m_fd;
+        input_event m_events[bufferSize];
+        std::size_t m_count;
+        bool m_isFailed;
+    };
+
+    class StreamFilter : public ChatterReplay
+    {
+    public:
+        StreamFilter(ChatterEngine& engine, EventWriter& writer, DeviceId device) :
+            ChatterReplay(engine),
+            eventCount(0),
+            keyEventCount(0),
+            blockedCount(0),
+            delayedCount(0),
+            releasedCount(0),
+            m_writer(writer),
+            m_currentEvent(nullptr),
+            m_device(device)
+        {
+            std::memset(m_keyOfCode, 0, sizeof(m_keyOfCode));
+            std::memset(m_codeOfKey, 0, sizeof(m_codeOfKey));
+            for (const EvdevKey& evdevKey : evdevKeys)
+            {
+                m_keyOfCode[evdevKey.code] = evdevKey.key;
+                if (m_codeOfKey[evdevKey.key] == 0)
+                    m_codeOfKey[evdevKey.key] = evdevKey.code;
+            }
+        }
+
+        void filter(const input_event& event)
+        {
+            eventCount++;
+
+            // The keys without virtual key code (buttons) are not filtered.
+            // The value 2 is an autorepeat, seen as a press like the Windows hook does.
+            const unsigned long key = event.type == EV_KEY && event.code < KEY_CNT ? m_keyOfCode[event.code] : 0;
+            if (key != 0)
+            {
+                keyEventCount++;
+                KeyEvent keyEvent = {};
+                keyEvent.time = eventTime(event);
+                keyEvent.key = key;
+                keyEvent.isPressed = event.value != 0;
+                keyEvent.device = m_device;
+
+                // A release written by the filter is the one of the last key pressed with this virtual key code.
+                if (keyEvent.isPressed)
+                    m_codeOfKey[key] = event.code;
+
+                m_currentEvent = &event;
+                replay(keyEvent);
+                m_currentEvent = nullptr;
+            }
+            else
+            {
+                releaseKeysUntil(eventTime(event));
+                m_writer.push(event);
+            }
+        }
+
+        std::size_t eventCount;
+        std::size_t keyEventCount;
+        std::size_t blockedCount;
+        std::size_t delayedCount;
+        std::size_t releasedCount;
+
+    protected:
+        void onKeyEvent(const KeyEvent&, const ChatterResult& result) override
+        {
+            if (result.decision == ChatterDecision::Pass)
+                m_writer.push(*m_currentEvent);
+            else if (result.decision == ChatterDecision::Block)
+                blockedCount++;
+            else
+                delayedCount++;
+        }
+
+        void onKeyRelease(ChatterTime time, DeviceId device, unsigned long key) override
+        {
+            (void)device;
+
+            // The release is a frame of its own.
+            input_event event = {};
+            setEventTime(event, time);
+            event.type = EV_KEY;
+            event.code = m_codeOfKey[key < ChatterEngine::keyCount ? key : 0];
+            event.value = 0;
+            m_writer.push(event);
+
+            event.type = EV_SYN;
+            event.code = SYN_REPORT;
+            event.value = 0;
+            m_writer.push(event);
+            releasedCount++;
+        }
+
+    private:
+        EventWriter& m_writer;
+        const input_event* m_currentEvent;
+        DeviceId m_device;
+        unsigned char m_keyOfCode[KEY_CNT];
+        unsigned short m_codeOfKey[ChatterEngine::keyCount];
+    };
+
+    // Control endpoint of the filter, called by the thread of the control server
+    // and by the configuration watcher. The engine publishes its new settings
+    // without stopping the filtering loop.
+    class FilterControl : public ControlTarget
+    {
+    public:
+        FilterControl(ChatterEngine& engine, const ChatterStatistics* statistics, const char* configPath) :
+            m_engine(engine),
+            m_statistics(statistics),
+            m_configPath(configPath)
+        {}
+
+        const ChatterStatistics* statistics() const override
+        {
+            return m_statistics;
+        }
+
+        const HookLatency* hookLatency() const override
+        {
+            return nullptr;
+        }
+
+        const HookWatchdog* hookWatchdog() const override
+        {
+            return nullptr;
+        }
+
+        ChatterTime chatterTime() const override
+        {
+            return m_engine.chatterTime();
+        }
+
+        void setChatterTime(ChatterTime time) override
+        {
+            m_engine.setChatterTime(time);
+        }
+
+        bool reloadConfig(std::string& error) override
+        {
+            // The chatter time is the default one of the configuration.
+            if (m_configPath == nullptr)
+            {
+                error = "no configuration file, see --config.";
+                return false;
+            }
+
+            ChatterConfig config;
+            config.setDefaultChatterTime(m_engine.chatterTime());
+            if (!config.readFile(m_configPath, error))
+                return false;
+            m_engine.setConfig(config);
+            return true;
+        }
+
+        bool isDebugEnabled() const override
+        {
+            return false;
+        }
+
+        bool enableDebug(bool enable) override
+        {
+            (void)enable;
+            return false;
+        }
+
+    private:
+        ChatterEngine& m_engine;
+        const ChatterStatistics* m_statistics;
+        const char* m_configPath;
+    };
+
+    void printUsage()
+    {
+        std::cout <<
+            "Usage: KeyChatteringFilter [options] [input]\n"
+            "Debounce the input_event records of an evdev device or a capture\n"
+            "(standard input if no input is given) and write them to the standard output.\n"
+            "  -t, --time=<ms>         Time since last press of the same key to treat this key has a chatter (default 50).\n"
+            "      --config=<file>     Read the chatter times of each key from a file, reloaded when it is written.\n"
+            "  -s, --stats=<file>      Keep live statistics into a memory mapped file.\n"
+            "  -c, --control=<socket>  Answer the requests of KeyChatteringControl on a Unix socket.\n"
+            "  -q, --quiet             Do not print the summary.\n"
+            "  -h, --help              Print usage information." << std::endl;
+    }
+
+    bool parseTime(const char* text, double& time)
+    {
+        char* end = nullptr;
+        time = std::strtod(text, &end);
+        return end != text && *end == '\0' && isValidChatterTime(time);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double chatterTime = 50.;
+    bool isQuiet = false;
+    const char* inputPath = nullptr;
+    const char* statisticsPath = nullptr;
+    const char* controlPath = nullptr;
+    const char* configPath = nullptr;
+
+    // Parsing the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0)
+        {
+            printUsage();
+            return EXIT_SUCCESS;
+        }
+        else if (std::strcmp(arg, "-q") == 0 || std::strcmp(arg, "--quiet") == 0)
+            isQuiet = true;
+        else if (std::strncmp(arg, "--time=", 7) == 0 || std::strcmp(arg, "-t") == 0)
+        {
+            const char* value = arg[1] == '-' ? arg + 7 : (i + 1 < argc ? argv[++i] : "");
+            if (!parseTime(value, chatterTime))
+            {
+                std::cerr << "-t, --time, invalid argument. The argument must be a number of milliseconds between 0.001 and 10000." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (std::strncmp(arg, "--config=", 9) == 0)
+        {
+            configPath = arg + 9;
+            if (*configPath == '\0')
+            {
+                std::cerr << "--config, invalid argument. The argument must be a file." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (std::strncmp(arg, "--stats=", 8) == 0 || std::strcmp(arg, "-s") == 0)
+        {
+            statisticsPath = arg[1] == '-' ? arg + 8 : (i + 1 < argc ? argv[++i] : "");
+            if (*statisticsPath == '\0')
+            {
+                std::cerr << "-s, --stats, invalid argument. The argument must be a file." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (std::strncmp(arg, "--control=", 10) == 0 || std::strcmp(arg, "-c") == 0)
+        {
+            controlPath = arg[1] == '-' ? arg + 10 : (i + 1 < argc ? argv[++i] : "");
+            if (*controlPath == '\0')
+            {
+                std::cerr << "-c, --control, invalid argument. The argument must be a socket path." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg[0] == '-' && arg[1] != '\0')
+        {
+            std::cerr << "Unknown option " << arg << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            inputPath = arg;
+    }
+
+    int input = STDIN_FILENO;
+    if (inputPath && std::strcmp(inputPath, "-") != 0)
+    {
+        input = ::open(inputPath, O_RDONLY);
+        if (input < 0)
+        {
+            std::cerr << "Cannot open " << inputPath << ": " << std::strerror(errno) << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // A file is filtered only from the time of its records.
+    struct stat inputStat = {};
+    const bool isLive = ::fstat(input, &inputStat) != 0 || !S_ISREG(inputStat.st_mode);
+
+    // A closed output is reported by write instead of killing the process.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    ChatterEngine engine;
+    engine.setChatterTime(chatterTimeFromMilliseconds(chatterTime));
+
+    StatisticsFile statisticsFile;
+    if (statisticsPath != nullptr)
+    {
+        std::string error;
+        if (!statisticsFile.create(statisticsPath, error))
+        {
+            std::cerr << "-s, --stats, " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+        engine.setStatistics(statisticsFile.statistics());
+    }
+
+    // The control endpoint counts into memory if there is no statistics file.
+    static ChatterStatistics localStatistics;
+    if (controlPath != nullptr && !statisticsFile.isOpen())
+        engine.setStatistics(&localStatistics);
+    FilterControl control(engine, statisticsFile.isOpen() ? statisticsFile.statistics() : &localStatistics,
+        configPath);
+
+    // The configuration is read again each time it is written.
+    ConfigWatcher configWatcher(control, std::cerr);
+    if (configPath != nullptr)
+    {
+        std::string error;
+        if (!control.reloadConfig(error) || !configWatcher.start(configPath, error))
+        {
+            std::cerr << "--config, " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    ControlServer controlServer(control);
+    if (controlPath != nullptr)
+    {
+        std::string error;
+        if (!controlServer.start(controlPath, error))
+        {
+            std::cerr << "-c, --control, " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    EventWriter writer(STDOUT_FILENO);
+    // The key data of an evdev device are kept under its device number.
+    const DeviceId device = S_ISCHR(inputStat.st_mode) ? static_cast<DeviceId>(inputStat.st_rdev) : defaultDevice;
+    StreamFilter filter(engine, writer, device);
+
+    input_event events[bufferSize];
+    std::size_t bufferedBytes = 0;
+    ChatterTime lastEventTime = ChatterTime::zero();
+    auto lastArrival = std::chrono::steady_clock::now();
+    bool isFailed = false;
+
+    auto startTime = std::chrono::steady_clock::now();
+    while (!writer.isFailed())
+    {
+        // While a release is delayed, wait for the input until it is due.
+        ChatterTime releaseTime;
+        if (isLive && filter.eventCount > 0 && engine.nextReleaseTime(releaseTime))
+        {
+            const ChatterTime streamTime = lastEventTime +
+                std::chrono::duration_cast<ChatterTime>(std::chrono::steady_clock::now() - lastArrival);
+            if (releaseTime <= streamTime)
+            {
+                filter.releaseKeysUntil(streamTime);
+                writer.flush();
+                continue;
+            }
+
+            pollfd descriptor = {};
+            descriptor.fd = input;
+            descriptor.events = POLLIN;
+            const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(releaseTime - streamTime);
+            if (::poll(&descriptor, 1, static_cast<int>(timeout.count()) + 1) == 0)
+                continue;
+        }
+
+        char* bytes = reinterpret_cast<char*>(events);
+        ssize_t readBytes = ::read(input, bytes + bufferedBytes, sizeof(events) - bufferedBytes);
+        if (readBytes < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "Cannot read the input: " << std::strerror(errno) << "." << std::endl;
+            isFailed = true;
+            break;
+        }
+        if (readBytes == 0)
+            break;
+
+        bufferedBytes += static_cast<std::size_t>(readBytes);
+        const std::size_t count = bufferedBytes / sizeof(input_event);
+        for (std::size_t i = 0; i < count; i++)
+            filter.filter(events[i]);
+
+        if (count > 0)
+        {
+            lastEventTime = eventTime(events[count - 1]);
+            lastArrival = std::chrono::steady_clock::now();
+        }
+
+        // Keep the beginning of a record cut by the read.
+        const std::size_t remainingBytes = bufferedBytes - count * sizeof(input_event);
+        std::memmove(bytes, bytes + count * sizeof(input_event), remainingBytes);
+        bufferedBytes = remainingBytes;
+
+        // The input is drained, the consumer should not wait for a full buffer.
+        if (count < bufferSize)
+            writer.flush();
+    }
+
+    // Write the releases still delayed at the end of the stream.
+    filter.releaseKeysUntil(ChatterTime::max());
+    writer.flush();
+    std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+
+    if (input != STDIN_FILENO)
+        ::close(input);
+
+    if (writer.isFailed())
+    {
+        std::cerr << "Cannot write the output." << std::endl;
+        isFailed = true;
+    }
+    else if (bufferedBytes > 0)
+        std::cerr << "The input ends with an incomplete record of " << bufferedBytes << " bytes." << std::endl;
+
+    if (!isQuiet)
+    {
+        std::cerr << "Events: " << filter.eventCount << std::endl;
+        std::cerr << "Key events: " << filter.keyEventCount << std::endl;
+        std::cerr << "Blocked presses: " << filter.blockedCount << std::endl;
+        std::cerr << "Delayed releases: " << filter.delayedCount << std::endl;
+        std::cerr << "Synthesized releases: " << filter.releasedCount << std::endl;
+        if (elapsedTime.count() > 0.)
+            std::cerr << "Events per second: " << static_cast<long long>(filter.eventCount / elapsedTime.count()) << std::endl;
+    }
+
+    return isFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,684 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ChatterReplay.h"
+#include "KeyTable.h"
+#include "VirtualKeyCodes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <queue>
+#include <random>
+#include <vector>
+
+/*
+* Differential test of the chatter engine.
+* A synthetic keyboard generates a stream of key events modelling a
+* real keyboard: typing cadence, rollover of several keys, autorepeat
+* and bounces (extra up/down pairs just after a press or a release),
+* on one or several keyboards typing at the same time.
+* The stream is given, chunk after chunk, to the chatter engine and to
+* a reference model written after the original KeyPressData: one thread
+* per delayed release, sleeping the time of chatter then checking the
+* last press and release of the key. The decisions and the synthesized
+* releases of both must be the same, the first divergence is printed.
+* The number of events processed per second by the engine is printed
+* at the end.
+*/
+
+namespace
+{
+    // Output of the engine or of the reference model for one event or one release.
+    struct Output
+    {
+        enum Type { Decision, Release };
+
+        Type type;
+        ChatterTime time;
+        unsigned long key;
+        DeviceId device;
+        ChatterDecision decision;
+        std::uint64_t eventIndex;
+    };
+
+    bool operator==(const Output& a, const Output& b)
+    {
+        return a.type == b.type && a.time == b.time && a.key == b.key && a.device == b.device &&
+            (a.type == Output::Release || a.decision == b.decision);
+    }
+
+    // Releases happening between the same events are compared whatever their order.
+    bool isBefore(const Output& a, const Output& b)
+    {
+        if (a.time != b.time)
+            return a.time < b.time;
+        if (a.device != b.device)
+            return a.device < b.device;
+        return a.key < b.key;
+    }
+
+    struct KeyboardModel
+    {
+        std::size_t keyCount;       // Number of different keys typed.
+        std::size_t deviceCount;    // Number of keyboards.
+        double interval;            // Mean time between two keystrokes (ms).
+        double holdTime;            // Mean time a key is held (ms).
+        std::size_t rollover;       // Maximum number of keys held together.
+        double autorepeat;          // Probability of a keystroke held long enough to repeat.
+        double bounce;              // Probability of a bounce after a press or a release.
+        double bounceTime;          // Maximum duration of a bounce (us).
+    };
+
+    /*
+    * Generate the key events of a keyboard following a KeyboardModel.
+    * Each keystroke is generated at once into a queue ordered by time,
+    * so the memory only depends on the number of keys held together.
+    * The times are strictly increasing, by one microsecond at least.
+    */
+    class SyntheticKeyboard
+    {
+    public:
+        SyntheticKeyboard(const KeyboardModel& model, std::uint64_t seed) :
+            m_model(model),
+            m_random(seed),
+            m_nextKeystroke(std::chrono::milliseconds(1)),
+            m_lastTime(ChatterTime::zero())
+        {
+            // Alpha keys, digits, then the rest of the keyboard.
+            static const unsigned long extraKeys[] = {
+                VK_SPACE, VK_RETURN, VK_BACK, VK_TAB, VK_LSHIFT, VK_OEM_PERIOD, VK_OEM_COMMA,
+                VK_OEM_1, VK_OEM_2, VK_OEM_MINUS, VK_LEFT, VK_RIGHT, VK_UP, VK_DOWN
+            };
+            for (unsigned long key = 'A'; key <= 'Z'; key++)
+                m_keys.push_back(key);
+            for (unsigned long key = '0'; key <= '9'; key++)
+                m_keys.push_back(key);
+            for (unsigned long key : extraKeys)
+                m_keys.push_back(key);
+            if (m_model.keyCount > 0 && m_model.keyCount < m_keys.size())
+                m_keys.resize(m_model.keyCount);
+
+            if (m_model.deviceCount == 0)
+                m_model.deviceCount = 1;
+            m_busyUntil.assign(ChatterEngine::keyCount * m_model.deviceCount, ChatterTime::zero());
+            m_heldUntil.assign(m_model.rollover > 0 ? m_model.rollover : 1, ChatterTime::zero());
+        }
+
+        KeyEvent next()
+        {
+            // Generate the keystrokes starting before the first pending event.
+            while (m_pending.empty() || m_pending.top().time > m_nextKeystroke)
+                generateKeystroke();
+
+            KeyEvent event = m_pending.top().event;
+            m_pending.pop();
+            if (event.time <= m_lastTime)
+                event.time = m_lastTime + ChatterTime(1);
+            m_lastTime = event.time;
+            return event;
+        }
+
+    private:
+        struct PendingEvent
+        {
+            ChatterTime time;
+            std::uint64_t order;
+            KeyEvent event;
+
+            bool operator>(const PendingEvent& other) const
+            {
+                return time != other.time ? time > other.time : order > other.order;
+            }
+        };
+
+        ChatterTime milliseconds(double msec)
+        {
+            return chatterTimeFromMilliseconds(msec);
+        }
+
+        double exponential(double mean)
+        {
+            return std::exponential_distribution<double>(1. / mean)(m_random);
+        }
+
+        double uniform(double minimum, double maximum)
+        {
+            return std::uniform_real_distribution<double>(minimum, maximum)(m_random);
+        }
+
+        void push(ChatterTime time, DeviceId device, unsigned long key, bool isPressed)
+        {
+            PendingEvent pending = {};
+            pending.time = time;
+            pending.order = m_order++;
+            pending.event.time = time;
+            pending.event.key = key;
+            pending.event.isPressed = isPressed;
+            pending.event.device = device;
+            m_pending.push(pending);
+        }
+
+        // Extra release and press just after a press (or press and release after a release).
+        ChatterTime pushBounces(ChatterTime time, DeviceId device, unsigned long key, bool isPressed, ChatterTime limit)
+        {
+            while (uniform(0., 1.) < m_model.bounce)
+            {
+                ChatterTime first = time + ChatterTime(1 + static_cast<ChatterTime::rep>(uniform(0., m_model.bounceTime / 2.)));
+                ChatterTime second = first + ChatterTime(1 + static_cast<ChatterTime::rep>(uniform(0., m_model.bounceTime / 2.)));
+                if (second >= limit)
+                    break;
+                push(first, device, key, !isPressed);
+                push(second, device, key, isPressed);
+                time = second;
+            }
+            return time;
+        }
+
+        void generateKeystroke()
+        {
+            ChatterTime start = m_nextKeystroke;
+            m_nextKeystroke += milliseconds(1. + exponential(m_model.interval));
+
+            // Rollover: wait for a key to be released if too many are held.
+            std::vector<ChatterTime>::iterator slot = std::min_element(m_heldUntil.begin(), m_heldUntil.end());
+            if (*slot > start)
+                start = *slot;
+
+            // A key not already held (or still bouncing) on one of the keyboards,
+            // the first keyboard is the default device.
+            const std::size_t deviceIndex = std::uniform_int_distribution<std::size_t>(0, m_model.deviceCount - 1)(m_random);
+            const DeviceId device = static_cast<DeviceId>(deviceIndex);
+            unsigned long key = m_keys[std::uniform_int_distribution<std::size_t>(0, m_keys.size() - 1)(m_random)];
+            ChatterTime& busyUntil = m_busyUntil[deviceIndex * ChatterEngine::keyCount + key];
+            if (busyUntil >= start)
+                start = busyUntil + ChatterTime(1);
+
+            // Held time, long enough to repeat for an autorepeat keystroke.
+            const bool isRepeating = uniform(0., 1.) < m_model.autorepeat;
+            double hold = isRepeating ? uniform(600., 1500.) : 5. + exponential(m_model.holdTime);
+            ChatterTime release = start + milliseconds(hold);
+
+            push(start, device, key, true);
+            ChatterTime time = pushBounces(start, device, key, true, release);
+            if (isRepeating)
+            {
+                for (ChatterTime repeat = start + milliseconds(500.); repeat < release; repeat += milliseconds(33.3))
+                {
+                    if (repeat > time)
+                        push(repeat, device, key, true);
+                }
+            }
+
+            push(release, device, key, false);
+            ChatterTime end = pushBounces(release, device, key, false, release + ChatterTime(static_cast<ChatterTime::rep>(m_model.bounceTime) + 1));
+
+            *slot = release;
+            busyUntil = end;
+            if (m_nextKeystroke < start)
+                m_nextKeystroke = start;
+        }
+
+        KeyboardModel m_model;
+        std::mt19937_64 m_random;
+        std::vector<unsigned long> m_keys;
+        std::vector<ChatterTime> m_busyUntil;
+        std::vector<ChatterTime> m_heldUntil;
+        std::priority_queue<PendingEvent, std::vector<PendingEvent>, std::greater<PendingEvent> > m_pending;
+        std::uint64_t m_order = 0;
+        ChatterTime m_nextKeystroke;
+        ChatterTime m_lastTime;
+    };
+
+    /*
+    * Reference model, the semantics of the original KeyPressData under
+    * a virtual clock. Each delayed release was a thread sleeping the time
+    * of chatter, so the threads wake up in the order they were created.
+    * Each device has its own key data.
+    */
+    class ReferenceModel
+    {
+    public:
+        explicit ReferenceModel(ChatterTime timeOfChatter) :
+            m_timeOfChatter(timeOfChatter)
+        {}
+
+        void process(const KeyEvent& event, std::uint64_t eventIndex, std::vector<Output>& outputs)
+        {
+            releaseKeysUntil(event.time, eventIndex, outputs);
+
+            Output output = {};
+            output.type = Output::Decision;
+            output.time = event.time;
+            output.key = event.key;
+            output.device = event.device;
+            output.eventIndex = eventIndex;
+            output.decision = event.isPressed ? press(event) : release(event);
+            outputs.push_back(output);
+        }
+
+        void releaseKeysUntil(ChatterTime time, std::uint64_t eventIndex, std::vector<Output>& outputs)
+        {
+            while (!m_threads.empty() && m_threads.front().wakeUpTime <= time)
+            {
+                const ReleaseThread thread = m_threads.front();
+                m_threads.pop_front();
+
+                // A newer release of the key exists, nothing to do.
+                const KeyState& state = m_devices[thread.device][thread.key];
+                if (thread.releaseTime < state.releaseTime)
+                    continue;
+
+                // The key has not been pressed again since the release: release it.
+                if (thread.releaseTime > state.lastPressTime)
+                {
+                    Output output = {};
+                    output.type = Output::Release;
+                    output.time = thread.wakeUpTime;
+                    output.key = thread.key;
+                    output.device = thread.device;
+                    output.eventIndex = eventIndex;
+                    outputs.push_back(output);
+                }
+            }
+        }
+
+    private:
+        struct KeyState
+        {
+            bool isPressed;
+            ChatterTime pressTime;      // Last press accepted outside of the time of chatter.
+            ChatterTime lastPressTime;  // Last press, chattering or not.
+            ChatterTime releaseTime;    // Last release.
+        };
+
+        struct ReleaseThread
+        {
+            ChatterTime wakeUpTime;
+            ChatterTime releaseTime;
+            DeviceId device;
+            unsigned long key;
+        };
+
+        KeyState* keyState(const KeyEvent& event)
+        {
+            if (event.key >= ChatterEngine::keyCount)
+                return nullptr;
+            std::vector<KeyState>& keys = m_devices[event.device];
+            if (keys.empty())
+                keys.resize(ChatterEngine::keyCount);
+            return &keys[event.key];
+        }
+
+        ChatterDecision press(const KeyEvent& event)
+        {
+            KeyState* keyInfo = keyState(event);
+            if (keyInfo == nullptr)
+                return ChatterDecision::Pass;
+
+            KeyState& state = *keyInfo;
+            if (!state.isPressed)
+            {
+                state.isPressed = true;
+                state.pressTime = event.time;
+                state.lastPressTime = event.time;
+                return ChatterDecision::Pass;
+            }
+
+            if (event.time - state.pressTime < m_timeOfChatter)
+            {
+                // A repeat key is accepted.
+                if (state.lastPressTime > state.releaseTime)
+                    return ChatterDecision::Pass;
+                state.lastPressTime = event.time;
+                return ChatterDecision::Block;
+            }
+
+            state.pressTime = event.time;
+            state.lastPressTime = event.time;
+            return ChatterDecision::Pass;
+        }
+
+        ChatterDecision release(const KeyEvent& event)
+        {
+            KeyState* keyInfo = keyState(event);
+            if (keyInfo == nullptr)
+                return ChatterDecision::Pass;
+
+            KeyState& state = *keyInfo;
+            state.releaseTime = event.time;
+            if (event.time - state.lastPressTime < m_timeOfChatter)
+            {
+                ReleaseThread thread = { event.time + m_timeOfChatter, event.time, event.device, event.key };
+                m_threads.push_back(thread);
+                return ChatterDecision::Delay;
+            }
+            return ChatterDecision::Pass;
+        }
+
+        ChatterTime m_timeOfChatter;
+        std::map<DeviceId, std::vector<KeyState> > m_devices;
+        std::deque<ReleaseThread> m_threads;
+    };
+
+    // The chatter engine, recording its outputs.
+    class EngineRun : public ChatterReplay
+    {
+    public:
+        EngineRun(ChatterEngine& engine, std::vector<Output>& outputs) :
+            ChatterReplay(engine),
+            m_outputs(outputs),
+            m_eventIndex(0)
+        {}
+
+        void process(const KeyEvent& event, std::uint64_t eventIndex)
+        {
+            m_eventIndex = eventIndex;
+            replay(event);
+        }
+
+        void finish(std::uint64_t eventIndex)
+        {
+            m_eventIndex = eventIndex;
+            releaseKeysUntil(ChatterTime::max());
+        }
+
+    protected:
+        void onKeyEvent(const KeyEvent& event, const ChatterResult& result) override
+        {
+            Output output = {};
+            output.type = Output::Decision;
+            output.time = event.time;
+            output.key = event.key;
+            output.device = event.device;
+            output.decision = result.decision;
+            output.eventIndex = m_eventIndex;
+            m_outputs.push_back(output);
+        }
+
+        void onKeyRelease(ChatterTime time, DeviceId device, unsigned long key) override
+        {
+            Output output = {};
+            output.type = Output::Release;
+            output.time = time;
+            output.key = key;
+            output.device = device;
+            output.eventIndex = m_eventIndex;
+            m_outputs.push_back(output);
+        }
+
+    private:
+        std::vector<Output>& m_outputs;
+        std::uint64_t m_eventIndex;
+    };
+
+    // Sort the releases between two decisions, their order is not specified.
+    void sortReleases(std::vector<Output>& outputs)
+    {
+        std::vector<Output>::iterator begin = outputs.begin();
+        while (begin != outputs.end())
+        {
+            if (begin->type != Output::Release)
+            {
+                ++begin;
+                continue;
+            }
+            std::vector<Output>::iterator end = begin;
+            while (end != outputs.end() && end->type == Output::Release)
+                ++end;
+            std::sort(begin, end, isBefore);
+            begin = end;
+        }
+    }
+
+    const char* decisionName(ChatterDecision decision)
+    {
+        switch (decision)
+        {
+        case ChatterDecision::Pass:
+            return "pass";
+        case ChatterDecision::Block:
+            return "block";
+        case ChatterDecision::Delay:
+            return "delay";
+        }
+        return "unknown";
+    }
+
+    void printDevice(DeviceId device)
+    {
+        if (device != defaultDevice)
+            std::fprintf(stderr, " on device %llu", static_cast<unsigned long long>(device));
+        std::fprintf(stderr, "\n");
+    }
+
+    void printOutput(const char* name, const std::vector<Output>& outputs, std::size_t i)
+    {
+        if (i >= outputs.size())
+        {
+            std::fprintf(stderr, "  %-9s (nothing)\n", name);
+            return;
+        }
+        const Output& o = outputs[i];
+        if (o.type == Output::Decision)
+            std::fprintf(stderr, "  %-9s %s %s at %.3f ms", name, decisionName(o.decision), keyName(o.key), chatterTimeToMilliseconds(o.time));
+        else
+            std::fprintf(stderr, "  %-9s release %s at %.3f ms", name, keyName(o.key), chatterTimeToMilliseconds(o.time));
+        printDevice(o.device);
+    }
+
+    void printEvents(const std::vector<KeyEvent>& events, std::size_t last)
+    {
+        // The events leading to the divergence.
+        std::size_t first = last >= 8 ? last - 8 : 0;
+        std::fprintf(stderr, "Last events:\n");
+        for (std::size_t i = first; i <= last && i < events.size(); i++)
+        {
+            std::fprintf(stderr, "  %.3f %s %s", chatterTimeToMilliseconds(events[i].time),
+                keyName(events[i].key), events[i].isPressed ? "down" : "up");
+            printDevice(events[i].device);
+        }
+    }
+
+    void printUsage()
+    {
+        std::printf(
+            "Usage: KeyChatteringOracle [options]\n"
+            "Compare the chatter engine with the reference model on a synthetic keyboard.\n"
+            "  -e, --events=<n>               Number of events (default 10000000).\n"
+            "  -s, --seed=<n>                 Seed of the generator (default 1).\n"
+            "  -t, --time=<ms>                Time of chatter (default 50).\n"
+            "  -k, --keys=<n>                 Number of different keys typed (default 50).\n"
+            "  -d, --devices=<n>              Number of keyboards typing together (default 1).\n"
+            "  -i, --interval=<ms>            Mean time between two keystrokes (default 120).\n"
+            "  -H, --hold=<ms>                Mean time a key is held (default 90).\n"
+            "  -r, --rollover=<n>             Maximum number of keys held together (default 4).\n"
+            "  -a, --autorepeat=<p>           Probability of an autorepeated keystroke (default 0.02).\n"
+            "  -b, --bounce=<p>,<us>          Probability of a bounce and its maximum duration (default 0.2,8000).\n"
+            "  -c, --chunk=<n>                Number of events generated at once (default 1000000).\n"
+            "  -h, --help                     Print usage information.\n");
+    }
+
+    const char* optionValue(int argc, char** argv, int& i, const char* shortName, const char* longName)
+    {
+        // Return the value of --long=value or -s value, nullptr if argv[i] is not this option.
+        std::size_t longLength = std::strlen(longName);
+        if (std::strncmp(argv[i], longName, longLength) == 0 && argv[i][longLength] == '=')
+            return argv[i] + longLength + 1;
+        if (std::strcmp(argv[i], shortName) == 0)
+            return i + 1 < argc ? argv[++i] : "";
+        return nullptr;
+    }
+
+    bool parseNumber(const char* text, double& number)
+    {
+        char* end = nullptr;
+        number = std::strtod(text, &end);
+        return end != text && *end == '\0' && number >= 0.;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::uint64_t eventCount = 10000000;
+    std::uint64_t seed = 1;
+    double chatterTime = 50.;
+    std::size_t chunkSize = 1000000;
+    KeyboardModel model = { 50, 1, 120., 90., 4, 0.02, 0.2, 8000. };
+
+    // Parsing the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        const char* option = argv[i];
+        const char* value = nullptr;
+        double number = 0.;
+        bool isValid = true;
+        if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0)
+        {
+            printUsage();
+            return EXIT_SUCCESS;
+        }
+        else if ((value = optionValue(argc, argv, i, "-e", "--events")) != nullptr)
+            isValid = (eventCount = std::strtoull(value, nullptr, 10)) > 0;
+        else if ((value = optionValue(argc, argv, i, "-s", "--seed")) != nullptr)
+            seed = std::strtoull(value, nullptr, 10);
+        else if ((value = optionValue(argc, argv, i, "-t", "--time")) != nullptr)
+            isValid = parseNumber(value, chatterTime) && isValidChatterTime(chatterTime);
+        else if ((value = optionValue(argc, argv, i, "-k", "--keys")) != nullptr)
+            isValid = (model.keyCount = std::strtoul(value, nullptr, 10)) > 0;
+        else if ((value = optionValue(argc, argv, i, "-d", "--devices")) != nullptr)
+            isValid = (model.deviceCount = std::strtoul(value, nullptr, 10)) > 0 && model.deviceCount <= ChatterEngine::defaultDeviceCount;
+        else if ((value = optionValue(argc, argv, i, "-i", "--interval")) != nullptr)
+            isValid = parseNumber(value, model.interval) && model.interval > 0.;
+        else if ((value = optionValue(argc, argv, i, "-H", "--hold")) != nullptr)
+            isValid = parseNumber(value, model.holdTime) && model.holdTime > 0.;
+        else if ((value = optionValue(argc, argv, i, "-r", "--rollover")) != nullptr)
+            isValid = (model.rollover = std::strtoul(value, nullptr, 10)) > 0;
+        else if ((value = optionValue(argc, argv, i, "-a", "--autorepeat")) != nullptr)
+            isValid = parseNumber(value, model.autorepeat) && model.autorepeat <= 1.;
+        else if ((value = optionValue(argc, argv, i, "-b", "--bounce")) != nullptr)
+        {
+            char* end = nullptr;
+            model.bounce = std::strtod(value, &end);
+            isValid = end != value && *end == ',' && model.bounce >= 0. && model.bounce < 1. &&
+                parseNumber(end + 1, number) && number >= 2.;
+            model.bounceTime = number;
+        }
+        else if ((value = optionValue(argc, argv, i, "-c", "--chunk")) != nullptr)
+            isValid = (chunkSize = std::strtoul(value, nullptr, 10)) > 0;
+        else
+        {
+            std::fprintf(stderr, "Unknown option %s.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+
+        if (!isValid)
+        {
+            std::fprintf(stderr, "Invalid argument for %s.\n", option);
+            return EXIT_FAILURE;
+        }
+    }
+
+    SyntheticKeyboard keyboard(model, seed);
+    ChatterEngine engine;
+    engine.setChatterTime(chatterTimeFromMilliseconds(chatterTime));
+    ReferenceModel reference(chatterTimeFromMilliseconds(chatterTime));
+
+    std::vector<KeyEvent> events;
+    std::vector<Output> engineOutputs;
+    std::vector<Output> referenceOutputs;
+    events.reserve(chunkSize);
+    engineOutputs.reserve(chunkSize * 2);
+    referenceOutputs.reserve(chunkSize * 2);
+    EngineRun engineRun(engine, engineOutputs);
+
+    std::uint64_t processedCount = 0;
+    std::uint64_t blockedCount = 0;
+    std::uint64_t delayedCount = 0;
+    std::uint64_t releasedCount = 0;
+    std::chrono::steady_clock::duration engineTime(0);
+
+    while (processedCount < eventCount)
+    {
+        // Generate a chunk, then give it to the engine and to the reference model.
+        events.clear();
+        engineOutputs.clear();
+        referenceOutputs.clear();
+        const std::uint64_t count = std::min<std::uint64_t>(chunkSize, eventCount - processedCount);
+        for (std::uint64_t i = 0; i < count; i++)
+            events.push_back(keyboard.next());
+        const bool isLastChunk = processedCount + count == eventCount;
+
+        auto startTime = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < events.size(); i++)
+            engineRun.process(events[i], processedCount + i);
+        if (isLastChunk)
+            engineRun.finish(processedCount + count);
+        engineTime += std::chrono::steady_clock::now() - startTime;
+
+        for (std::size_t i = 0; i < events.size(); i++)
+            reference.process(events[i], processedCount + i, referenceOutputs);
+        if (isLastChunk)
+            reference.releaseKeysUntil(ChatterTime::max(), processedCount + count, referenceOutputs);
+
+        sortReleases(engineOutputs);
+        sortReleases(referenceOutputs);
+
+        // Report the first divergence.
+        const std::size_t outputCount = std::max(engineOutputs.size(), referenceOutputs.size());
+        for (std::size_t i = 0; i < outputCount; i++)
+        {
+            if (i < engineOutputs.size() && i < referenceOutputs.size() && engineOutputs[i] == referenceOutputs[i])
+            {
+                const Output& o = engineOutputs[i];
+                if (o.type == Output::Release)
+                    releasedCount++;
+                else if (o.decision == ChatterDecision::Block)
+                    blockedCount++;
+                else if (o.decision == ChatterDecision::Delay)
+                    delayedCount++;
+                continue;
+            }
+
+            const Output& o = i < referenceOutputs.size() ? referenceOutputs[i] : engineOutputs[i];
+            std::fprintf(stderr, "Divergence at event %llu (seed %llu):\n",
+                static_cast<unsigned long long>(o.eventIndex), static_cast<unsigned long long>(seed));
+            printOutput("reference", referenceOutputs, i);
+            printOutput("engine", engineOutputs, i);
+            printEvents(events, static_cast<std::size_t>(std::min<std::uint64_t>(o.eventIndex - processedCount, events.size() - 1)));
+            return EXIT_FAILURE;
+        }
+
+        processedCount += count;
+    }
+
+    const double seconds = std::chrono::duration<double>(engineTime).count();
+    std::printf("Events: %llu\n", static_cast<unsigned long long>(processedCount));
+    std::printf("Blocked presses: %llu\n", static_cast<unsigned long long>(blockedCount));
+    std::printf("Delayed releases: %llu\n", static_cast<unsigned long long>(delayedCount));
+    std::printf("Synthesized releases: %llu\n", static_cast<unsigned long long>(releasedCount));
+    std::printf("No divergence.\n");
+    if (seconds > 0.)
+        std::printf("Engine events per second: %.0f\n", processedCount / seconds);
+    return EXIT_SUCCESS;
+}
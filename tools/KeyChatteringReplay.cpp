@@ -0,0 +1,286 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ChatterReplay.h"
+#include "KeyEventRecording.h"
+#include "KeyEventTrace.h"
+#include "KeyTable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* Replay a key event trace, or a binary recording of --record (without
+* the delayed releases sent by the program), through the chatter engine
+* under a virtual clock and print its decisions:
+*   block <time> <key> <time since last press>
+*   delay <time> <key> <release time>
+*   release <time> <key>
+* followed by device=<device> for the events of another device than the default one.
+* The summary (and the number of events processed per second)
+* is printed on the error output, so the decisions of two runs
+* can be compared with diff.
+*/
+
+namespace
+{
+    struct ReplayOutput
+    {
+        char type;
+        double time;
+        unsigned long key;
+        double value;
+        DeviceId device;
+    };
+
+    class RecordingReplay : public ChatterReplay
+    {
+    public:
+        RecordingReplay(ChatterEngine& engine, std::size_t eventCount) :
+            ChatterReplay(engine),
+            blockedCount(0),
+            delayedCount(0),
+            releasedCount(0)
+        {
+            // Reserve the output before the replay, so the throughput
+            // measured is the one of the engine.
+            output.reserve(eventCount * 2);
+        }
+
+        std::vector<ReplayOutput> output;
+        std::size_t blockedCount;
+        std::size_t delayedCount;
+        std::size_t releasedCount;
+
+    protected:
+        void onKeyEvent(const KeyEvent& event, const ChatterResult& result) override
+        {
+            if (result.decision == ChatterDecision::Block)
+            {
+                ReplayOutput o = { 'b', chatterTimeToMilliseconds(event.time), event.key, chatterTimeToMilliseconds(result.timeSinceLastPress), event.device };
+                output.push_back(o);
+                blockedCount++;
+            }
+            else if (result.decision == ChatterDecision::Delay)
+            {
+                ReplayOutput o = { 'd', chatterTimeToMilliseconds(event.time), event.key, chatterTimeToMilliseconds(result.releaseTime), event.device };
+                output.push_back(o);
+                delayedCount++;
+            }
+        }
+
+        void onKeyRelease(ChatterTime time, DeviceId device, unsigned long key) override
+        {
+            ReplayOutput o = { 'r', chatterTimeToMilliseconds(time), key, 0., device };
+            output.push_back(o);
+            releasedCount++;
+        }
+    };
+
+    void printUsage()
+    {
+        std::cout <<
+            "Usage: KeyChatteringReplay [options] [trace file]\n"
+            "Replay a key event trace or a recording of --record (standard input if no file is given).\n"
+            "  -t, --time=<ms>              Time since last press of the same key to treat this key has a chatter (default 50).\n"
+            "  -a, --adaptive=<min>,<max>   Learn the time of chatter of each key, between min and max ms.\n"
+            "  -c, --config=<file>          Read the chatter times of each key from a configuration file.\n"
+            "  -q, --quiet                  Only print the summary.\n"
+            "  -h, --help                   Print usage information." << std::endl;
+    }
+
+    bool parseTime(const char* text, double& time)
+    {
+        char* end = nullptr;
+        time = std::strtod(text, &end);
+        return end != text && *end == '\0' && isValidChatterTime(time);
+    }
+
+    bool parseTimeRange(const char* text, double& minimum, double& maximum)
+    {
+        char* end = nullptr;
+        minimum = std::strtod(text, &end);
+        if (end == text || *end != ',' || minimum < 0.)
+            return false;
+        return parseTime(end + 1, maximum) && minimum <= maximum;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double chatterTime = 50.;
+    bool isQuiet = false;
+    bool isAdaptive = false;
+    double adaptiveMinimum = 0.;
+    double adaptiveMaximum = 0.;
+    const char* configPath = nullptr;
+    const char* tracePath = nullptr;
+
+    // Parsing the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0)
+        {
+            printUsage();
+            return EXIT_SUCCESS;
+        }
+        else if (std::strcmp(arg, "-q") == 0 || std::strcmp(arg, "--quiet") == 0)
+            isQuiet = true;
+        else if (std::strncmp(arg, "--time=", 7) == 0 || std::strcmp(arg, "-t") == 0)
+        {
+            const char* value = arg[1] == '-' ? arg + 7 : (i + 1 < argc ? argv[++i] : "");
+            if (!parseTime(value, chatterTime))
+            {
+                std::cerr << "-t, --time, invalid argument. The argument must be a number of milliseconds between 0.001 and 10000." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (std::strncmp(arg, "--adaptive=", 11) == 0 || std::strcmp(arg, "-a") == 0)
+        {
+            const char* value = arg[1] == '-' ? arg + 11 : (i + 1 < argc ? argv[++i] : "");
+            if (!parseTimeRange(value, adaptiveMinimum, adaptiveMaximum))
+            {
+                std::cerr << "-a, --adaptive, invalid argument. The argument must be <min>,<max> in milliseconds, at most 10000." << std::endl;
+                return EXIT_FAILURE;
+            }
+            isAdaptive = true;
+        }
+        else if (std::strncmp(arg, "--config=", 9) == 0 || std::strcmp(arg, "-c") == 0)
+            configPath = arg[1] == '-' ? arg + 9 : (i + 1 < argc ? argv[++i] : "");
+        else if (arg[0] == '-' && arg[1] != '\0')
+        {
+            std::cerr << "Unknown option " << arg << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            tracePath = arg;
+    }
+
+    // Reading the trace.
+    std::vector<KeyEvent> events;
+    std::string error;
+    bool isRead = false;
+    if (tracePath && std::strcmp(tracePath, "-") != 0 && KeyEventRecordingFile::isRecording(tracePath))
+        isRead = readKeyEventRecording(tracePath, events, error);
+    else if (tracePath && std::strcmp(tracePath, "-") != 0)
+    {
+        std::ifstream file(tracePath);
+        if (!file)
+        {
+            std::cerr << "Cannot open " << tracePath << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+        isRead = readKeyEventTrace(file, events, error);
+    }
+    else
+        isRead = readKeyEventTrace(std::cin, events, error);
+
+    if (!isRead)
+    {
+        std::cerr << "Invalid trace, " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Reading the configuration, --time is the default chatter time.
+    ChatterConfig config;
+    config.setDefaultChatterTime(chatterTimeFromMilliseconds(chatterTime));
+    if (configPath)
+    {
+        std::ifstream file(configPath);
+        if (!file)
+        {
+            std::cerr << "Cannot open " << configPath << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (!config.read(file, error))
+        {
+            std::cerr << "Invalid configuration, " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Replaying the trace.
+    ChatterEngine engine;
+    engine.setConfig(config);
+    if (isAdaptive &&
+        !engine.enableAdaptiveChatterTime(chatterTimeFromMilliseconds(adaptiveMinimum), chatterTimeFromMilliseconds(adaptiveMaximum)))
+    {
+        std::cerr << "-a, --adaptive, the chatter policy of this build never learns the chatter times." << std::endl;
+        return EXIT_FAILURE;
+    }
+    RecordingReplay replay(engine, events.size());
+
+    auto startTime = std::chrono::steady_clock::now();
+    replay.replay(events);
+    std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+
+    if (!isQuiet)
+    {
+        for (const ReplayOutput& o : replay.output)
+        {
+            switch (o.type)
+            {
+            case 'b':
+                std::printf("block %.3f %lu %.3f", o.time, o.key, o.value);
+                break;
+            case 'd':
+                std::printf("delay %.3f %lu %.3f", o.time, o.key, o.value);
+                break;
+            case 'r':
+                std::printf("release %.3f %lu", o.time, o.key);
+                break;
+            }
+            if (o.device != defaultDevice)
+                std::printf(" device=%llu", static_cast<unsigned long long>(o.device));
+            std::printf("\n");
+        }
+        std::fflush(stdout);
+    }
+
+    std::cerr << "Events: " << events.size() << std::endl;
+    std::cerr << "Blocked presses: " << replay.blockedCount << std::endl;
+    std::cerr << "Delayed releases: " << replay.delayedCount << std::endl;
+    std::cerr << "Synthesized releases: " << replay.releasedCount << std::endl;
+    if (elapsedTime.count() > 0.)
+        std::cerr << "Events per second: " << static_cast<long long>(events.size() / elapsedTime.count()) << std::endl;
+
+    // The time of chatter learned for the keys of the trace.
+    if (isAdaptive)
+    {
+        bool isKeySeen[ChatterEngine::keyCount] = {};
+        for (const KeyEvent& event : events)
+        {
+            if (event.key < ChatterEngine::keyCount)
+                isKeySeen[event.key] = true;
+        }
+        for (unsigned long key = 0; key < ChatterEngine::keyCount; key++)
+        {
+            if (isKeySeen[key])
+                std::cerr << "Chatter time of " << keyName(key) << ": " << chatterTimeToMilliseconds(engine.keyChatterTime(key).press) << " ms" << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "KeyTable.h"
+#include "StatisticsFile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+/*
+* Print the live statistics of a running KeyChattering (or KeyChatteringFilter)
+* from its memory mapped statistics file. The file is only read, the
+* filtering program is never called. With --watch, the counters are printed
+* again every given number of seconds, with the number of events of the period.
+*/
+
+namespace
+{
+    const ChatterCounter counters[chatterCounterCount] = {
+        ChatterCounter::PressesSeen,
+        ChatterCounter::PressesBlocked,
+        ChatterCounter::ReleasesDeferred,
+        ChatterCounter::ReleasesInjected,
+        ChatterCounter::ReleasesCancelled
+    };
+
+    const char* const counterNames[chatterCounterCount] = {
+        "presses", "blocked", "deferred", "injected", "cancelled"
+    };
+
+    struct Snapshot
+    {
+        std::uint64_t counts[256][chatterCounterCount];
+        std::uint64_t totals[chatterCounterCount];
+        std::uint64_t releaseBatches;
+        std::uint64_t unknownKeyEvents;
+    };
+
+    void takeSnapshot(const ChatterStatistics& statistics, Snapshot& snapshot)
+    {
+        for (std::size_t i = 0; i < chatterCounterCount; i++)
+            snapshot.totals[i] = 0;
+        for (std::size_t key = 0; key < 256; key++)
+        {
+            for (std::size_t i = 0; i < chatterCounterCount; i++)
+            {
+                snapshot.counts[key][i] = statistics.count(key, counters[i]);
+                snapshot.totals[i] += snapshot.counts[key][i];
+            }
+        }
+        snapshot.releaseBatches = statistics.releaseBatches.load(std::memory_order_relaxed);
+        snapshot.unknownKeyEvents = statistics.unknownKeyEvents.load(std::memory_order_relaxed);
+    }
+
+    void printRow(const char* name, const std::uint64_t* counts)
+    {
+        std::printf("%-16s", name);
+        for (std::size_t i = 0; i < chatterCounterCount; i++)
+            std::printf(" %12llu", static_cast<unsigned long long>(counts[i]));
+        std::printf("\n");
+    }
+
+    void printSnapshot(const ChatterStatistics& statistics, const Snapshot& snapshot, bool isAllKeys)
+    {
+        std::printf("Process %u, started %lld.\n", statistics.processId, static_cast<long long>(statistics.startTime));
+        std::printf("%-16s", "key");
+        for (std::size_t i = 0; i < chatterCounterCount; i++)
+            std::printf(" %12s", counterNames[i]);
+        std::printf("\n");
+
+        // The keys never pressed are only printed with --all.
+        for (std::size_t key = 0; key < 256; key++)
+        {
+            bool isUsed = isAllKeys;
+            for (std::size_t i = 0; i < chatterCounterCount && !isUsed; i++)
+                isUsed = snapshot.counts[key][i] != 0;
+            if (isUsed)
+                printRow(keyName(static_cast<unsigned long>(key)), snapshot.counts[key]);
+        }
+
+        printRow("total", snapshot.totals);
+        std::printf("Release batches: %llu\n", static_cast<unsigned long long>(snapshot.releaseBatches));
+        std::printf("Unknown key events: %llu\n", static_cast<unsigned long long>(snapshot.unknownKeyEvents));
+        std::fflush(stdout);
+    }
+
+    void printUsage()
+    {
+        std::cout <<
+            "Usage: KeyChatteringStats [options] <statistics file>\n"
+            "Print the live statistics written by KeyChattering --stats.\n"
+            "  -a, --all              Print every key, even never pressed.\n"
+            "  -w, --watch=<seconds>  Print the statistics again every period.\n"
+            "  -h, --help             Print usage information." << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool isAllKeys = false;
+    double watchPeriod = 0.;
+    const char* path = nullptr;
+
+    // Parsing the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0)
+        {
+            printUsage();
+            return EXIT_SUCCESS;
+        }
+        else if (std::strcmp(arg, "-a") == 0 || std::strcmp(arg, "--all") == 0)
+            isAllKeys = true;
+        else if (std::strncmp(arg, "--watch=", 8) == 0 || std::strcmp(arg, "-w") == 0)
+        {
+            const char* value = arg[1] == '-' ? arg + 8 : (i + 1 < argc ? argv[++i] : "");
+            char* end = nullptr;
+            watchPeriod = std::strtod(value, &end);
+            if (end == value || *end != '\0' || watchPeriod <= 0.)
+            {
+                std::cerr << "-w, --watch, invalid argument. The argument must be a positive number." << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg[0] == '-' && arg[1] != '\0')
+        {
+            std::cerr << "Unknown option " << arg << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            path = arg;
+    }
+
+    if (path == nullptr)
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    StatisticsFile file;
+    std::string error;
+    if (!file.open(path, error))
+    {
+        std::cerr << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    static Snapshot snapshot;
+    takeSnapshot(*file.statistics(), snapshot);
+    printSnapshot(*file.statistics(), snapshot, isAllKeys);
+
+    while (watchPeriod > 0.)
+    {
+        // The events of the period are the difference of two snapshots.
+        static Snapshot previous;
+        previous = snapshot;
+        std::this_thread::sleep_for(std::chrono::duration<double>(watchPeriod));
+        takeSnapshot(*file.statistics(), snapshot);
+
+        std::uint64_t period[chatterCounterCount];
+        for (std::size_t i = 0; i < chatterCounterCount; i++)
+            period[i] = snapshot.totals[i] - previous.totals[i];
+        std::printf("\n");
+        printSnapshot(*file.statistics(), snapshot, isAllKeys);
+        printRow("period", period);
+        std::fflush(stdout);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,417 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ChatterReplay.h"
+#include "KeyEventRecording.h"
+#include "KeyEventTrace.h"
+#include "KeyTable.h"
+#include "WorkStealingPool.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+* Replay a key event trace, or a recording of --record, through the
+* chatter engine for every chatter time of a grid, to choose --time from
+* the events of a keyboard instead of trying it live. The points of the
+* grid are independent replays of the whole trace, run on every core by
+* a WorkStealingPool.
+* For each chatter time are printed the blocked presses, the delayed
+* releases, the releases sent by the engine and the suspected false
+* positives: the blocked presses coming long after the release of the
+* key (--double-tap), which look like a key pressed twice on purpose
+* rather than a bounce. With --per-key, the same counts are printed for
+* each key of the trace.
+* The suggested chatter time, globally and for each key, is the shortest
+* one reaching the plateau of the bounces: it blocks all but --tolerance
+* percent of the presses blocked without suspicion by the longest times,
+* and its suspected false positives are at most --tolerance percent of its
+* blocked presses. A longer time would only add suspected false positives
+* and delay more releases.
+*/
+
+namespace
+{
+    // Largest grid of chatter times, each point keeps the counts of the keys of the trace.
+    const std::size_t maxPointCount = 10000;
+
+    struct SweepCounts
+    {
+        std::uint64_t blocked;
+        std::uint64_t delayed;
+        std::uint64_t released;
+        std::uint64_t suspected;
+    };
+
+    // Counts of the replay of the trace for one chatter time,
+    // for each key of the trace in the order of seenKeysOf.
+    struct SweepPoint
+    {
+        ChatterTime chatterTime;
+        SweepCounts total;
+        std::vector<SweepCounts> keys;
+    };
+
+    class SweepReplay : public ChatterReplay
+    {
+    public:
+        SweepReplay(ChatterEngine& engine, const std::vector<ChatterTime>& releasedTimes,
+            const std::vector<std::size_t>& keyIndexes, ChatterTime doubleTapTime, SweepPoint& point) :
+            ChatterReplay(engine),
+            m_releasedTimes(releasedTimes),
+            m_keyIndexes(keyIndexes),
+            m_doubleTapTime(doubleTapTime),
+            m_point(point)
+        {}
+
+    protected:
+        void onKeyEvent(const KeyEvent& event, const ChatterResult& result) override
+        {
+            if (event.key >= ChatterEngine::keyCount)
+                return;
+            SweepCounts& counts = m_point.keys[m_keyIndexes[event.key]];
+            if (result.decision == ChatterDecision::Block)
+            {
+                // The index of the event in the trace gives the time the key was released.
+                counts.blocked++;
+                if (m_releasedTimes[eventIndex()] >= m_doubleTapTime)
+                    counts.suspected++;
+            }
+            else if (result.decision == ChatterDecision::Delay)
+                counts.delayed++;
+        }
+
+        void onKeyRelease(ChatterTime, DeviceId, unsigned long key) override
+        {
+            if (key < ChatterEngine::keyCount)
+                m_point.keys[m_keyIndexes[key]].released++;
+        }
+
+    private:
+        const std::vector<ChatterTime>& m_releasedTimes;
+        const std::vector<std::size_t>& m_keyIndexes;
+        ChatterTime m_doubleTapTime;
+        SweepPoint& m_point;
+    };
+
+    // The keys of the trace in increasing order, and the index of each of them among these keys.
+    std::vector<unsigned long> seenKeysOf(const std::vector<KeyEvent>& events, std::vector<std::size_t>& keyIndexes)
+    {
+        std::vector<bool> isKeySeen(ChatterEngine::keyCount, false);
+        for (const KeyEvent& event : events)
+        {
+            if (event.key < ChatterEngine::keyCount)
+                isKeySeen[event.key] = true;
+        }
+
+        std::vector<unsigned long> seenKeys;
+        keyIndexes.assign(ChatterEngine::keyCount, 0);
+        for (unsigned long key = 0; key < ChatterEngine::keyCount; key++)
+        {
+            if (!isKeySeen[key])
+                continue;
+            keyIndexes[key] = seenKeys.size();
+            seenKeys.push_back(key);
+        }
+        return seenKeys;
+    }
+
+    // Time each press comes after the last release of its key on its device, max without release.
+    std::vector<ChatterTime> releasedTimesOf(const std::vector<KeyEvent>& events)
+    {
+        std::vector<ChatterTime> releasedTimes(events.size(), ChatterTime::max());
+        std::map<DeviceId, std::vector<ChatterTime> > lastReleases;
+        for (std::size_t i = 0; i < events.size(); i++)
+        {
+            const KeyEvent& event = events[i];
+            if (event.key >= ChatterEngine::keyCount)
+                continue;
+            std::vector<ChatterTime>& deviceReleases = lastReleases[event.device];
+            if (deviceReleases.empty())
+                deviceReleases.assign(ChatterEngine::keyCount, ChatterTime::min());
+            if (!event.isPressed)
+                deviceReleases[event.key] = event.time;
+            else if (deviceReleases[event.key] != ChatterTime::min())
+                releasedTimes[i] = event.time - deviceReleases[event.key];
+        }
+        return releasedTimes;
+    }
+
+    void addCounts(SweepCounts& total, const SweepCounts& counts)
+    {
+        total.blocked += counts.blocked;
+        total.delayed += counts.delayed;
+        total.released += counts.released;
+        total.suspected += counts.suspected;
+    }
+
+    void printCounts(const SweepCounts& counts)
+    {
+        std::printf(" %llu %llu %llu %llu\n",
+            static_cast<unsigned long long>(counts.blocked), static_cast<unsigned long long>(counts.delayed),
+            static_cast<unsigned long long>(counts.released), static_cast<unsigned long long>(counts.suspected));
+    }
+
+    bool isSuggestible(const SweepCounts& counts, double tolerance)
+    {
+        return counts.blocked > 0 && counts.suspected <= counts.blocked * tolerance / 100.;
+    }
+
+    // The shortest chatter time reaching the plateau of the bounces with few suspected presses,
+    // false if there is none. The points are sorted by chatter time.
+    template<typename CountsOf>
+    bool suggestChatterTime(const std::vector<SweepPoint>& points, CountsOf countsOf, double tolerance, ChatterTime& chatterTime)
+    {
+        std::uint64_t plateau = 0;
+        for (const SweepPoint& point : points)
+        {
+            const SweepCounts& counts = countsOf(point);
+            if (isSuggestible(counts, tolerance))
+                plateau = std::max(plateau, counts.blocked - counts.suspected);
+        }
+        if (plateau == 0)
+            return false;
+
+        for (const SweepPoint& point : points)
+        {
+            const SweepCounts& counts = countsOf(point);
+            if (isSuggestible(counts, tolerance) && counts.blocked - counts.suspected >= plateau * (1. - tolerance / 100.))
+            {
+                chatterTime = point.chatterTime;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void printUsage()
+    {
+        std::cout <<
+            "Usage: KeyChatteringTune [options] [trace file]\n"
+            "Replay a key event trace or a recording of --record (standard input if no file is given)\n"
+            "for each chatter time of a grid, and print the decisions of the engine for each time.\n"
+            "  -r, --range=<min>,<max>      Chatter times swept, in ms (default 1,100).\n"
+            "  -s, --step=<ms>              Step between two chatter times (default 0.5).\n"
+            "  -k, --per-key                Print the counts of each key too.\n"
+            "  -d, --double-tap=<ms>        A blocked press this long after the release of its key\n"
+            "                               is a suspected false positive (default 30).\n"
+            "  -T, --tolerance=<percent>    Suspected false positives allowed at the suggested chatter\n"
+            "                               times, in percent of the blocked presses, and bounces left\n"
+            "                               unblocked, in percent of the plateau (default 1).\n"
+            "  -j, --threads=<n>            Number of threads (default one per core).\n"
+            "  -h, --help                   Print usage information." << std::endl;
+    }
+
+    const char* optionValue(int argc, char** argv, int& i, const char* shortName, const char* longName)
+    {
+        // Return the value of --long=value or -s value, nullptr if argv[i] is not this option.
+        std::size_t longLength = std::strlen(longName);
+        if (std::strncmp(argv[i], longName, longLength) == 0 && argv[i][longLength] == '=')
+            return argv[i] + longLength + 1;
+        if (std::strcmp(argv[i], shortName) == 0)
+            return i + 1 < argc ? argv[++i] : "";
+        return nullptr;
+    }
+
+    bool parseNumber(const char* text, double& number)
+    {
+        char* end = nullptr;
+        number = std::strtod(text, &end);
+        return end != text && *end == '\0' && number >= 0.;
+    }
+
+    bool parseCount(const char* text, std::size_t& count)
+    {
+        // strtoul accepts a sign, the count is only digits.
+        char* end = nullptr;
+        count = std::strtoul(text, &end, 10);
+        return *text >= '0' && *text <= '9' && *end == '\0' && count > 0;
+    }
+
+    bool parseRange(const char* text, double& minimum, double& maximum)
+    {
+        char* end = nullptr;
+        minimum = std::strtod(text, &end);
+        if (end == text || *end != ',' || minimum < 0.001)
+            return false;
+        return parseNumber(end + 1, maximum) && isValidChatterTime(maximum) && minimum <= maximum;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double minimumTime = 1.;
+    double maximumTime = 100.;
+    double step = 0.5;
+    double doubleTapTime = 30.;
+    double tolerance = 1.;
+    bool isPerKey = false;
+    std::size_t threadCount = 0;
+    const char* tracePath = nullptr;
+
+    // Parsing the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        const char* option = argv[i];
+        const char* value = nullptr;
+        bool isValid = true;
+        if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0)
+        {
+            printUsage();
+            return EXIT_SUCCESS;
+        }
+        else if (std::strcmp(argv[i], "-k") == 0 || std::strcmp(argv[i], "--per-key") == 0)
+            isPerKey = true;
+        else if ((value = optionValue(argc, argv, i, "-r", "--range")) != nullptr)
+            isValid = parseRange(value, minimumTime, maximumTime);
+        else if ((value = optionValue(argc, argv, i, "-s", "--step")) != nullptr)
+            isValid = parseNumber(value, step) && step >= 0.001;
+        else if ((value = optionValue(argc, argv, i, "-d", "--double-tap")) != nullptr)
+            isValid = parseNumber(value, doubleTapTime);
+        else if ((value = optionValue(argc, argv, i, "-T", "--tolerance")) != nullptr)
+            isValid = parseNumber(value, tolerance) && tolerance <= 100.;
+        else if ((value = optionValue(argc, argv, i, "-j", "--threads")) != nullptr)
+            isValid = parseCount(value, threadCount);
+        else if (argv[i][0] == '-' && argv[i][1] != '\0')
+        {
+            std::cerr << "Unknown option " << argv[i] << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+        else
+            tracePath = argv[i];
+
+        if (!isValid)
+        {
+            std::cerr << "Invalid argument for " << option << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Reading the trace.
+    std::vector<KeyEvent> events;
+    std::string error;
+    bool isRead = false;
+    if (tracePath && std::strcmp(tracePath, "-") != 0 && KeyEventRecordingFile::isRecording(tracePath))
+        isRead = readKeyEventRecording(tracePath, events, error);
+    else if (tracePath && std::strcmp(tracePath, "-") != 0)
+    {
+        std::ifstream file(tracePath);
+        if (!file)
+        {
+            std::cerr << "Cannot open " << tracePath << "." << std::endl;
+            return EXIT_FAILURE;
+        }
+        isRead = readKeyEventTrace(file, events, error);
+    }
+    else
+        isRead = readKeyEventTrace(std::cin, events, error);
+
+    if (!isRead)
+    {
+        std::cerr << "Invalid trace, " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The grid of chatter times, the counts start at zero. Only the keys of the trace are counted.
+    const double pointCount = (maximumTime - minimumTime) / step + 1e-6 + 1.;
+    if (pointCount > maxPointCount)
+    {
+        std::cerr << "The grid has more than " << maxPointCount << " chatter times, increase --step or narrow --range." << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<std::size_t> keyIndexes;
+    const std::vector<unsigned long> seenKeys = seenKeysOf(events, keyIndexes);
+    std::vector<SweepPoint> points(static_cast<std::size_t>(pointCount));
+    for (std::size_t i = 0; i < points.size(); i++)
+    {
+        points[i].chatterTime = chatterTimeFromMilliseconds(minimumTime + step * i);
+        points[i].total = SweepCounts();
+        points[i].keys.assign(seenKeys.size(), SweepCounts());
+    }
+
+    // Replaying the trace for each chatter time.
+    const std::vector<ChatterTime> releasedTimes = releasedTimesOf(events);
+    const ChatterTime doubleTap = chatterTimeFromMilliseconds(doubleTapTime);
+    WorkStealingPool pool(threadCount);
+
+    auto startTime = std::chrono::steady_clock::now();
+    pool.run(points.size(), [&](std::size_t i)
+    {
+        SweepPoint& point = points[i];
+        ChatterEngine engine;
+        engine.setChatterTime(point.chatterTime);
+        SweepReplay replay(engine, releasedTimes, keyIndexes, doubleTap, point);
+        replay.replay(events);
+        for (const SweepCounts& counts : point.keys)
+            addCounts(point.total, counts);
+    });
+    std::chrono::duration<double> elapsedTime = std::chrono::steady_clock::now() - startTime;
+
+    // The counts of each chatter time: the totals, then the keys.
+    std::printf("# time blocked delayed released suspected\n");
+    for (const SweepPoint& point : points)
+    {
+        std::printf("%.3f", chatterTimeToMilliseconds(point.chatterTime));
+        printCounts(point.total);
+    }
+    if (isPerKey)
+    {
+        std::printf("# time key blocked delayed released suspected\n");
+        for (const SweepPoint& point : points)
+        {
+            for (std::size_t k = 0; k < seenKeys.size(); k++)
+            {
+                std::printf("%.3f %lu", chatterTimeToMilliseconds(point.chatterTime), seenKeys[k]);
+                printCounts(point.keys[k]);
+            }
+        }
+    }
+    std::fflush(stdout);
+
+    std::cerr << "Events: " << events.size() << std::endl;
+    std::cerr << "Chatter times: " << points.size() << std::endl;
+    std::cerr << "Threads: " << pool.threadCount() << " (" << pool.stolenCount() << " chatter times stolen)" << std::endl;
+    if (elapsedTime.count() > 0.)
+        std::cerr << "Events per second: " << static_cast<long long>(events.size() * points.size() / elapsedTime.count()) << std::endl;
+
+    ChatterTime suggestedTime;
+    if (suggestChatterTime(points, [](const SweepPoint& point) -> const SweepCounts& { return point.total; }, tolerance, suggestedTime))
+        std::cerr << "Suggested chatter time: " << chatterTimeToMilliseconds(suggestedTime) << " ms" << std::endl;
+    else
+        std::cerr << "No chatter time blocks presses with few suspected false positives." << std::endl;
+
+    // The suggested time of each key, as the lines of a configuration file.
+    if (isPerKey)
+    {
+        for (std::size_t k = 0; k < seenKeys.size(); k++)
+        {
+            if (suggestChatterTime(points, [k](const SweepPoint& point) -> const SweepCounts& { return point.keys[k]; }, tolerance, suggestedTime))
+                std::cerr << "key " << seenKeys[k] << " time=" << chatterTimeToMilliseconds(suggestedTime) << " # " << keyName(seenKeys[k]) << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
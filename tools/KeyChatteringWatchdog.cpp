@@ -0,0 +1,400 @@
+/*
+* MIT Licence
+*
+* KeyChattering
+*
+* Copyright © 2021 Erwan Saclier de la Bâtie (Erwan28250)
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), 
+* to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, 
+* and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, 
+* WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "HookWatchdog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* Test of the hook watchdog without Windows.
+* A simulated system sends key events to a simulated low level hook
+* running on its own thread, like the message loop of the Windows hook:
+* the system waits for each callback at most the hook timeout, then
+* drops the hook, as Windows 7 and later do. Some callbacks stall longer
+* than the timeout, and some hooks are dropped without a stall, before
+* an event sent by the program itself (a delayed release), which the
+* watchdog expects to see. The watchdog must report every stall and every
+* drop and install the hook again, the events lost meanwhile and the
+* longest recovery are printed.
+*/
+
+namespace
+{
+    struct HookMessage
+    {
+        enum Type { Event, Probe, Quit };
+
+        Type type;
+        ChatterTime stallTime;
+    };
+
+    // A hook and the thread of its message loop.
+    class SimulatedHook
+    {
+        SimulatedHook(const SimulatedHook&) = delete;
+        SimulatedHook& operator=(const SimulatedHook&) = delete;
+
+    public:
+        SimulatedHook(HookWatchdog& watchdog, const ChatterClock& clock) :
+            m_watchdog(watchdog),
+            m_clock(clock),
+            m_sentEvents(0),
+            m_answeredEvents(0)
+        {
+            m_thread = std::thread(&SimulatedHook::run, this);
+        }
+
+        ~SimulatedHook()
+        {
+            post(HookMessage::Quit, ChatterTime::zero());
+            m_thread.join();
+        }
+
+        // Give an event to the callback and wait for its answer at most timeout.
+        bool call(ChatterTime stallTime, ChatterTime timeout)
+        {
+            const std::uint64_t event = post(HookMessage::Event, stallTime);
+            std::unique_lock<std::mutex> lock(m_mutex);
+            return m_condition.wait_for(lock, timeout, [&]() { return m_answeredEvents >= event; });
+        }
+
+        void probe()
+        {
+            post(HookMessage::Probe, ChatterTime::zero());
+        }
+
+        // The thread exits after the messages already posted.
+        void quit()
+        {
+            post(HookMessage::Quit, ChatterTime::zero());
+        }
+
+    private:
+        std::uint64_t post(HookMessage::Type type, ChatterTime stallTime)
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            HookMessage message = { type, stallTime };
+            m_messages.push_back(message);
+            m_condition.notify_all();
+            return type == HookMessage::Event ? ++m_sentEvents : m_sentEvents;
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;)
+            {
+                m_condition.wait(lock, [this]() { return !m_messages.empty(); });
+                const HookMessage message = m_messages.front();
+                m_messages.pop_front();
+                if (message.type == HookMessage::Quit)
+                    return;
+
+                lock.unlock();
+                if (message.type == HookMessage::Probe)
+                    m_watchdog.answerProbe();
+                else
+                {
+                    const ChatterTime startTime = m_clock.now();
+                    m_watchdog.enterCallback(startTime);
+                    if (message.stallTime > ChatterTime::zero())
+                        std::this_thread::sleep_for(message.stallTime);
+                    m_watchdog.leaveCallback(startTime);
+                }
+                lock.lock();
+
+                if (message.type == HookMessage::Event)
+                {
+                    m_answeredEvents++;
+                    m_condition.notify_all();
+                }
+            }
+        }
+
+        HookWatchdog& m_watchdog;
+        const ChatterClock& m_clock;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<HookMessage> m_messages;
+        std::uint64_t m_sentEvents;
+        std::uint64_t m_answeredEvents;
+        std::thread m_thread;
+    };
+
+    // The input system, calling the installed hook for each event.
+    class SimulatedSystem : public WatchedHook
+    {
+    public:
+        SimulatedSystem(HookWatchdog& watchdog, const ChatterClock& clock, ChatterTime hookTimeout) :
+            m_watchdog(watchdog),
+            m_clock(clock),
+            m_hookTimeout(hookTimeout),
+            m_installCount(0)
+        {}
+
+        // Return false if the event is lost: no hook, or a hook too slow.
+        bool sendEvent(ChatterTime stallTime)
+        {
+            std::shared_ptr<SimulatedHook> hook;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                hook = m_hook;
+            }
+            if (!hook)
+                return false;
+            if (hook->call(stallTime, m_hookTimeout))
+                return true;
+
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (m_hook == hook)
+                retireHook();
+            return false;
+        }
+
+        // Remove the hook without telling it.
+        void dropHook()
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            retireHook();
+        }
+
+        bool reinstall() override
+        {
+            std::shared_ptr<SimulatedHook> hook = std::make_shared<SimulatedHook>(m_watchdog, m_clock);
+            std::lock_guard<std::mutex> guard(m_mutex);
+            retireHook();
+            m_hook = hook;
+            m_installCount++;
+            return true;
+        }
+
+        void probe() override
+        {
+            // The probe of a dropped hook is lost.
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (m_hook)
+                m_hook->probe();
+        }
+
+        std::uint64_t installCount()
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            return m_installCount;
+        }
+
+    private:
+        void retireHook()
+        {
+            // The thread of a stalled hook exits after its callback.
+            if (!m_hook)
+                return;
+            m_hook->quit();
+            m_retiredHooks.push_back(m_hook);
+            m_hook.reset();
+        }
+
+        HookWatchdog& m_watchdog;
+        const ChatterClock& m_clock;
+        ChatterTime m_hookTimeout;
+        std::mutex m_mutex;
+        std::shared_ptr<SimulatedHook> m_hook;
+        std::vector<std::shared_ptr<SimulatedHook> > m_retiredHooks;
+        std::uint64_t m_installCount;
+    };
+
+    void printUsage()
+    {
+        std::printf(
+            "Usage: KeyChatteringWatchdog [options]\n"
+            "Check the hook watchdog against a simulated hook which stalls and is dropped.\n"
+            "  -e, --events=<n>               Number of events (default 4000).\n"
+            "  -i, --interval=<ms>            Time between two events (default 1).\n"
+            "  -t, --timeout=<ms>             Timeout of the hook callbacks (default 40).\n"
+            "  -s, --stalls=<n>               Number of stalled callbacks (default 5).\n"
+            "  -d, --drops=<n>                Number of hooks dropped without a stall (default 5).\n"
+            "  -l, --stall=<ms>               Duration of a stalled callback (default 3 timeouts).\n"
+            "  -h, --help                     Print usage information.\n");
+    }
+
+    const char* optionValue(int argc, char** argv, int& i, const char* shortName, const char* longName)
+    {
+        // Return the value of --long=value or -s value, nullptr if argv[i] is not this option.
+        std::size_t longLength = std::strlen(longName);
+        if (std::strncmp(argv[i], longName, longLength) == 0 && argv[i][longLength] == '=')
+            return argv[i] + longLength + 1;
+        if (std::strcmp(argv[i], shortName) == 0)
+            return i + 1 < argc ? argv[++i] : "";
+        return nullptr;
+    }
+
+    bool parseNumber(const char* text, double& number)
+    {
+        char* end = nullptr;
+        number = std::strtod(text, &end);
+        return end != text && *end == '\0' && number >= 0.;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::uint64_t eventCount = 4000;
+    double interval = 1.;
+    double timeout = 40.;
+    double stallDuration = 0.;
+    std::uint64_t stallCount = 5;
+    std::uint64_t dropCount = 5;
+
+    // Parsing the command line.
+    for (int i = 1; i < argc; i++)
+    {
+        const char* option = argv[i];
+        const char* value = nullptr;
+        bool isValid = true;
+        if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0)
+        {
+            printUsage();
+            return EXIT_SUCCESS;
+        }
+        else if ((value = optionValue(argc, argv, i, "-e", "--events")) != nullptr)
+            isValid = (eventCount = std::strtoull(value, nullptr, 10)) > 0;
+        else if ((value = optionValue(argc, argv, i, "-i", "--interval")) != nullptr)
+            isValid = parseNumber(value, interval) && interval > 0.;
+        else if ((value = optionValue(argc, argv, i, "-t", "--timeout")) != nullptr)
+            isValid = parseNumber(value, timeout) && timeout >= 1.;
+        else if ((value = optionValue(argc, argv, i, "-s", "--stalls")) != nullptr)
+            stallCount = std::strtoull(value, nullptr, 10);
+        else if ((value = optionValue(argc, argv, i, "-d", "--drops")) != nullptr)
+            dropCount = std::strtoull(value, nullptr, 10);
+        else if ((value = optionValue(argc, argv, i, "-l", "--stall")) != nullptr)
+            isValid = parseNumber(value, stallDuration) && stallDuration > 0.;
+        else
+        {
+            std::fprintf(stderr, "Unknown option %s.\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+
+        if (!isValid)
+        {
+            std::fprintf(stderr, "Invalid argument for %s.\n", option);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (stallDuration == 0.)
+        stallDuration = timeout * 3.;
+    const std::uint64_t faultCount = stallCount + dropCount;
+    const std::uint64_t faultSpacing = eventCount / (faultCount + 1);
+    if (faultCount > 0 && faultSpacing == 0)
+    {
+        std::fprintf(stderr, "Not enough events for %llu faults.\n", static_cast<unsigned long long>(faultCount));
+        return EXIT_FAILURE;
+    }
+
+    SteadyChatterClock clock;
+    HookWatchdog watchdog(clock, std::cout);
+    SimulatedSystem system(watchdog, clock, chatterTimeFromMilliseconds(timeout));
+    system.reinstall();
+    HookWatchdogSettings settings = { chatterTimeFromMilliseconds(timeout) };
+    watchdog.start(system, settings);
+
+    // The faults are spread over the events, a stall and a drop in turn.
+    std::uint64_t stalls = 0;
+    std::uint64_t drops = 0;
+    std::uint64_t lostEvents = 0;
+    bool isRecovering = false;
+    ChatterTime faultTime = ChatterTime::zero();
+    ChatterTime longestRecovery = ChatterTime::zero();
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    const std::chrono::steady_clock::duration eventInterval =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(chatterTimeFromMilliseconds(interval));
+
+    for (std::uint64_t i = 1; i <= eventCount; i++)
+    {
+        std::this_thread::sleep_until(startTime + eventInterval * static_cast<long>(i));
+
+        ChatterTime stallTime = ChatterTime::zero();
+        bool isExpected = false;
+        if (faultSpacing > 0 && i % faultSpacing == 0 && stalls + drops < faultCount)
+        {
+            isRecovering = true;
+            faultTime = clock.now();
+            if (stalls < stallCount && (drops >= dropCount || stalls <= drops))
+            {
+                stallTime = chatterTimeFromMilliseconds(stallDuration);
+                stalls++;
+            }
+            else
+            {
+                system.dropHook();
+                isExpected = true;
+                drops++;
+            }
+        }
+
+        // The events sent by the program are told to the watchdog.
+        if (isExpected)
+            watchdog.expectCallback();
+
+        if (!system.sendEvent(stallTime))
+        {
+            lostEvents++;
+            continue;
+        }
+        if (isRecovering && stallTime == ChatterTime::zero())
+        {
+            longestRecovery = std::max(longestRecovery, clock.now() - faultTime);
+            isRecovering = false;
+        }
+    }
+
+    // The hook must still receive the events.
+    const bool isInstalled = system.sendEvent(ChatterTime::zero());
+    watchdog.stop();
+
+    const std::uint64_t detectedStalls = watchdog.incidentCount(HookIncident::Stall);
+    const std::uint64_t detectedDrops = watchdog.incidentCount(HookIncident::Drop);
+    std::printf("Events: %llu\n", static_cast<unsigned long long>(eventCount));
+    std::printf("Lost events: %llu\n", static_cast<unsigned long long>(lostEvents));
+    std::printf("Stalls: %llu injected, %llu detected\n",
+        static_cast<unsigned long long>(stalls), static_cast<unsigned long long>(detectedStalls));
+    std::printf("Drops: %llu injected, %llu detected\n",
+        static_cast<unsigned long long>(drops), static_cast<unsigned long long>(detectedDrops));
+    std::printf("Hook installs: %llu\n", static_cast<unsigned long long>(system.installCount()));
+    std::printf("Longest recovery: %.1f ms\n", chatterTimeToMilliseconds(longestRecovery));
+
+    if (!isInstalled || detectedStalls != stalls || detectedDrops != drops ||
+        watchdog.incidentCount(HookIncident::FailedInstall) != 0)
+    {
+        std::printf("The watchdog missed an incident.\n");
+        return EXIT_FAILURE;
+    }
+    std::printf("Every incident was detected.\n");
+    return EXIT_SUCCESS;
+}